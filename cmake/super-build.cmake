@@ -76,6 +76,7 @@ add_external_project(axhost
     CMAKE_CACHE_ARGS
         "-DAXHOST_SUPERBUILD:BOOL=OFF"
         "-DAXHOST_OUTPUT_NAME:STRING=${AXHOST_OUTPUT_NAME}"
+        "-DBUILD_TESTING:BOOL=${BUILD_TESTING}"
     DEPENDS qt6 cli11 spdlog wil
 )
 
@@ -0,0 +1,100 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "apartment_thread.h"
+
+#include <wil/result.h>
+
+#include <QSharedPointer>
+
+#include "com_initialize_context.h"
+
+HostApartmentThread::HostApartmentThread(
+    const QString &name, DWORD coInit, QObject *parent
+)
+    : QThread(parent),
+      m_coInit(coInit) {
+  setObjectName(name);
+  m_ready.create(wil::EventOptions::ManualReset);
+}
+
+HostApartmentThread::~HostApartmentThread() {
+  quit();
+  wait();
+}
+
+void HostApartmentThread::run() {
+  ComInitializeContext com(m_coInit);
+  if (!com.IsInitialized()) {
+    m_ready.SetEvent();
+    return;
+  }
+  QObject context;
+  m_context = &context;
+  m_ready.SetEvent();
+  exec();
+  m_context = nullptr;
+}
+
+bool HostApartmentThread::Start() {
+  start();
+  m_ready.wait();
+  return m_context != nullptr;
+}
+
+void HostApartmentThread::AddInstance() { ++m_instanceCount; }
+
+void HostApartmentThread::ReleaseInstance() { --m_instanceCount; }
+
+int HostApartmentThread::GetInstanceCount() const { return m_instanceCount; }
+
+HRESULT HostApartmentThread::Invoke(const std::function<HRESULT()> &function) {
+  if (QThread::currentThread() == this)
+    return function();
+  if (!m_context)
+    return E_UNEXPECTED;
+
+  // Shared with the queued call, which may still run after a failed wait.
+  struct Call {
+    HRESULT result = E_ABORT;
+    wil::unique_event done;
+  };
+  QSharedPointer<Call> call = QSharedPointer<Call>::create();
+  call->done.create(wil::EventOptions::ManualReset);
+  if (!call->done)
+    return E_OUTOFMEMORY;
+
+  bool posted = QMetaObject::invokeMethod(
+      m_context,
+      [call, function] {
+        call->result = function();
+        call->done.SetEvent();
+      },
+      Qt::QueuedConnection
+  );
+  if (!posted)
+    return E_UNEXPECTED;
+
+  HANDLE hEventRaw = call->done.get();
+  DWORD index = 0;
+  RETURN_IF_FAILED(CoWaitForMultipleHandles(
+      COWAIT_INPUTAVAILABLE | COWAIT_DISPATCH_CALLS, INFINITE, 1, &hEventRaw,
+      &index
+  ));
+  return call->result;
+}
@@ -0,0 +1,65 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef APARTMENT_THREAD_H
+#define APARTMENT_THREAD_H
+
+#include <atomic>
+#include <functional>
+
+#include <windows.h>
+
+#include <wil/resource.h>
+
+#include <QObject>
+#include <QString>
+#include <QThread>
+
+// Thread running its own single-threaded apartment and message pump, or
+// joined to the multithreaded apartment. Work is queued to the thread with
+// Invoke, which keeps dispatching COM calls on the calling apartment while
+// it waits.
+class HostApartmentThread : public QThread {
+  Q_OBJECT
+
+private:
+  DWORD m_coInit;
+  wil::unique_event m_ready;
+  QObject *m_context = nullptr;
+
+  std::atomic<int> m_instanceCount{0};
+
+protected:
+  void run() override;
+
+public:
+  HostApartmentThread(
+      const QString &name, DWORD coInit = COINIT_APARTMENTTHREADED,
+      QObject *parent = nullptr
+  );
+  ~HostApartmentThread();
+
+  bool Start();
+  HRESULT Invoke(const std::function<HRESULT()> &function);
+
+  void AddInstance();
+  void ReleaseInstance();
+  int GetInstanceCount() const;
+};
+
+#endif // APARTMENT_THREAD_H
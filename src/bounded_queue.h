@@ -0,0 +1,120 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+// Bounded lock-free queue with exactly one producer thread. Elements are
+// taken out by one consumer thread, and by the producer as well when it
+// evicts the oldest one, so the head is shared and only advanced with a CAS.
+// The capacity is rounded up to a power of two.
+template <typename T> class BoundedQueue {
+  static_assert(std::is_trivially_copyable_v<T>);
+
+private:
+  std::size_t m_capacity;
+  std::size_t m_mask;
+  std::unique_ptr<std::atomic<T>[]> m_slots;
+
+  alignas(64) std::atomic<std::size_t> m_head{0};
+  alignas(64) std::atomic<std::size_t> m_tail{0};
+
+  static std::size_t RoundUpCapacity(std::size_t capacity) {
+    std::size_t n = 1;
+    while (n < capacity)
+      n <<= 1;
+    return n;
+  }
+
+public:
+  explicit BoundedQueue(std::size_t capacity)
+      : m_capacity(RoundUpCapacity(capacity)),
+        m_mask(m_capacity - 1),
+        m_slots(new std::atomic<T>[m_capacity]) {}
+
+  BoundedQueue(const BoundedQueue &) = delete;
+  BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+  std::size_t Capacity() const { return m_capacity; }
+
+  std::size_t Size() const {
+    std::size_t tail = m_tail.load(std::memory_order_acquire);
+    std::size_t head = m_head.load(std::memory_order_acquire);
+    return tail - head;
+  }
+
+  bool IsEmpty() const { return Size() == 0; }
+
+  // Producer side.
+  bool TryPush(const T &value) {
+    std::size_t tail = m_tail.load(std::memory_order_relaxed);
+    std::size_t head = m_head.load(std::memory_order_acquire);
+    if (tail - head >= m_capacity)
+      return false;
+    m_slots[tail & m_mask].store(value, std::memory_order_relaxed);
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Producer side. When the queue is full the oldest element is taken out to
+  // make room for the new one and handed back through evicted.
+  bool PushEvicting(const T &value, T &evicted) {
+    std::size_t tail = m_tail.load(std::memory_order_relaxed);
+    std::size_t head = m_head.load(std::memory_order_acquire);
+    bool hasEvicted = false;
+    while (tail - head >= m_capacity) {
+      T oldest = m_slots[head & m_mask].load(std::memory_order_relaxed);
+      if (m_head.compare_exchange_weak(
+              head, head + 1, std::memory_order_acq_rel,
+              std::memory_order_acquire
+          )) {
+        evicted = oldest;
+        hasEvicted = true;
+        break;
+      }
+    }
+    m_slots[tail & m_mask].store(value, std::memory_order_relaxed);
+    m_tail.store(tail + 1, std::memory_order_release);
+    return hasEvicted;
+  }
+
+  // Consumer side.
+  bool TryPop(T &value) {
+    std::size_t head = m_head.load(std::memory_order_acquire);
+    while (true) {
+      std::size_t tail = m_tail.load(std::memory_order_acquire);
+      if (head == tail)
+        return false;
+      T candidate = m_slots[head & m_mask].load(std::memory_order_relaxed);
+      if (m_head.compare_exchange_weak(
+              head, head + 1, std::memory_order_acq_rel,
+              std::memory_order_acquire
+          )) {
+        value = candidate;
+        return true;
+      }
+    }
+  }
+};
+
+#endif // BOUNDED_QUEUE_H
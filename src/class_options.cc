@@ -0,0 +1,279 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "class_options.h"
+
+#include <algorithm>
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QList>
+#include <QRegularExpression>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+
+#include "diagnostics.h"
+
+// Every connection allocates its queue up front.
+static constexpr int kMaxQueueCapacity = 65536;
+
+bool ClassOptions::set(const QString &key, const QString &value) {
+  if (key == "apartment") {
+    if (value == "main") {
+      apartment = ClassApartment::Main;
+    } else if (value == "dedicated") {
+      apartment = ClassApartment::Dedicated;
+    } else if (value == "sharded") {
+      apartment = ClassApartment::Sharded;
+    } else if (value == "free") {
+      apartment = ClassApartment::Free;
+    } else if (value == "auto") {
+      apartment = ClassApartment::Auto;
+    } else {
+      return false;
+    }
+    return true;
+  }
+  if (key == "shards") {
+    bool ok = false;
+    int count = value.toInt(&ok, 0);
+    if (!ok || count < 0)
+      return false;
+    shards = count;
+    return true;
+  }
+  if (key == "placement") {
+    if (value == "least-loaded") {
+      placement = ShardPlacement::LeastLoaded;
+    } else if (value == "round-robin") {
+      placement = ShardPlacement::RoundRobin;
+    } else {
+      return false;
+    }
+    return true;
+  }
+  if (key == "delivery") {
+    if (value == "pooled") {
+      delivery = EventDelivery::Pooled;
+    } else if (value == "ordered") {
+      delivery = EventDelivery::Ordered;
+    } else {
+      return false;
+    }
+    return true;
+  }
+  if (key == "events") {
+    if (value == "sync") {
+      events = EventMode::Sync;
+    } else if (value == "async") {
+      events = EventMode::Async;
+    } else {
+      return false;
+    }
+    return true;
+  }
+  if (key == "overflow") {
+    if (value == "block") {
+      overflow = EventOverflow::Block;
+    } else if (value == "drop-oldest") {
+      overflow = EventOverflow::DropOldest;
+    } else if (value == "drop-newest") {
+      overflow = EventOverflow::DropNewest;
+    } else {
+      return false;
+    }
+    return true;
+  }
+  if (key == "coalesce") {
+    return parseDispIdList(value, coalesce, ":");
+  }
+  if (key == "queue") {
+    bool ok = false;
+    int capacity = value.toInt(&ok, 0);
+    if (!ok || capacity <= 0 || capacity > kMaxQueueCapacity)
+      return false;
+    queueCapacity = capacity;
+    return true;
+  }
+  if (key == "prewarm") {
+    bool ok = false;
+    int count = value.toInt(&ok, 0);
+    if (!ok || count < 0)
+      return false;
+    prewarm = count;
+    return true;
+  }
+  if (key == "recycle") {
+    bool ok = false;
+    int count = value.toInt(&ok, 0);
+    if (!ok || count < 0)
+      return false;
+    recycle = count;
+    return true;
+  }
+  if (key == "recycle-idle") {
+    bool ok = false;
+    int seconds = value.toInt(&ok, 0);
+    if (!ok || seconds <= 0)
+      return false;
+    recycleIdleSeconds = seconds;
+    return true;
+  }
+  if (key == "reset") {
+    if (value.isEmpty())
+      return false;
+    reset = value;
+    return true;
+  }
+  if (key == "profile") {
+    if (value == "on") {
+      profile = true;
+    } else if (value == "off") {
+      profile = false;
+    } else {
+      return false;
+    }
+    return true;
+  }
+  return false;
+}
+
+QString ClassOptions::toString() const {
+  QStringList parts;
+  if (apartment == ClassApartment::Dedicated) {
+    parts << "apartment=dedicated";
+  } else if (apartment == ClassApartment::Sharded) {
+    parts << "apartment=sharded";
+  } else if (apartment == ClassApartment::Free) {
+    parts << "apartment=free";
+  } else if (apartment == ClassApartment::Auto) {
+    parts << "apartment=auto";
+  }
+  if (shards > 0) {
+    parts << QString("shards=%1").arg(shards);
+  }
+  if (placement == ShardPlacement::RoundRobin) {
+    parts << "placement=round-robin";
+  }
+  if (delivery == EventDelivery::Ordered) {
+    parts << "delivery=ordered";
+  }
+  if (events == EventMode::Async) {
+    parts << "events=async";
+  }
+  if (overflow == EventOverflow::DropOldest) {
+    parts << "overflow=drop-oldest";
+  } else if (overflow == EventOverflow::DropNewest) {
+    parts << "overflow=drop-newest";
+  }
+  if (queueCapacity != ClassOptions().queueCapacity) {
+    parts << QString("queue=%1").arg(queueCapacity);
+  }
+  if (!coalesce.isEmpty()) {
+    QList<DISPID> dispIds = coalesce.values();
+    std::sort(dispIds.begin(), dispIds.end());
+    QStringList items;
+    for (DISPID dispId : dispIds) {
+      items << QString::number(dispId);
+    }
+    parts << QString("coalesce=%1").arg(items.join(":"));
+  }
+  if (prewarm > 0) {
+    parts << QString("prewarm=%1").arg(prewarm);
+  }
+  if (recycle > 0) {
+    parts << QString("recycle=%1").arg(recycle);
+  }
+  if (recycleIdleSeconds != ClassOptions().recycleIdleSeconds) {
+    parts << QString("recycle-idle=%1").arg(recycleIdleSeconds);
+  }
+  if (!reset.isEmpty()) {
+    parts << QString("reset=%1").arg(reset);
+  }
+  if (profile) {
+    parts << "profile=on";
+  }
+  return parts.join(",");
+}
+
+ClassOptions ClassOptions::fromString(const QString &item) {
+  ClassOptions options;
+  for (const QString &part : item.split(",", Qt::SkipEmptyParts)) {
+    QString key = part.section('=', 0, 0).trimmed().toLower();
+    QString value = part.section('=', 1).trimmed();
+    // The reset method is looked up as written, since a control's own
+    // GetIDsOfNames may match names case sensitively.
+    if (key != "reset") {
+      value = value.toLower();
+    }
+    if (!options.set(key, value)) {
+      QString text = QString(R"(
+Error: Class Option Parsing Failed
+
+Invalid class option: '%1'
+)")
+                         .arg(part.trimmed())
+                         .trimmed();
+      Diagnostics::Warning(text);
+    }
+  }
+  return options;
+}
+
+bool ClassOptions::parseDispIdList(
+    const QString &text, QSet<DISPID> &out, const QString &separators
+) {
+  QRegularExpression pattern(
+      QString("[%1\\s]+").arg(QRegularExpression::escape(separators))
+  );
+  const QStringList items = text.split(pattern, Qt::SkipEmptyParts);
+  if (items.isEmpty())
+    return false;
+  QSet<DISPID> parsed;
+  for (const QString &item : items) {
+    bool ok = false;
+    DISPID dispId = item.toInt(&ok, 0);
+    // Reserved DISPIDs are usually written as unsigned hex, like 0x80010000.
+    if (!ok) {
+      dispId = static_cast<DISPID>(item.toUInt(&ok, 0));
+    }
+    if (!ok)
+      return false;
+    parsed.insert(dispId);
+  }
+  out.unite(parsed);
+  return true;
+}
+
+bool ClassOptions::readDispIdFile(const QString &path, QSet<DISPID> &out) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    return false;
+  QTextStream stream(&file);
+  QSet<DISPID> parsed;
+  while (!stream.atEnd()) {
+    QString line = stream.readLine().section('#', 0, 0).trimmed();
+    if (line.isEmpty())
+      continue;
+    if (!parseDispIdList(line, parsed, ","))
+      return false;
+  }
+  out.unite(parsed);
+  return true;
+}
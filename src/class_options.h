@@ -0,0 +1,81 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef CLASS_OPTIONS_H
+#define CLASS_OPTIONS_H
+
+#include <windows.h>
+
+#include <QSet>
+#include <QString>
+
+#include "event_queue.h"
+
+enum class ClassApartment {
+  Main,
+  Dedicated,
+  Sharded,
+  Free,
+  Auto,
+};
+
+enum class ShardPlacement {
+  LeastLoaded,
+  RoundRobin,
+};
+
+enum class EventDelivery {
+  Pooled,
+  Ordered,
+};
+
+enum class EventMode {
+  Sync,
+  Async,
+};
+
+class ClassOptions {
+public:
+  ClassApartment apartment = ClassApartment::Main;
+  int shards = 0;
+  ShardPlacement placement = ShardPlacement::LeastLoaded;
+  EventDelivery delivery = EventDelivery::Pooled;
+  EventMode events = EventMode::Sync;
+  EventOverflow overflow = EventOverflow::Block;
+  int queueCapacity = 1024;
+  QSet<DISPID> coalesce;
+  int prewarm = 0;
+  int recycle = 0;
+  int recycleIdleSeconds = 300;
+  QString reset;
+  bool profile = false;
+
+public:
+  bool set(const QString &key, const QString &value);
+  QString toString() const;
+
+public:
+  static ClassOptions fromString(const QString &item);
+
+  static bool parseDispIdList(
+      const QString &text, QSet<DISPID> &out, const QString &separators
+  );
+  static bool readDispIdFile(const QString &path, QSet<DISPID> &out);
+};
+
+#endif // CLASS_OPTIONS_H
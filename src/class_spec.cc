@@ -21,11 +21,12 @@
 #include <string>
 
 #include <QCoreApplication>
-#include <QMessageBox>
 #include <QString>
 #include <QStringList>
 #include <QUuid>
 
+#include "diagnostics.h"
+
 HRESULT CLSIDFromQString(const QString &s, QUuid &u) {
   return CLSIDFromString(
       reinterpret_cast<LPCOLESTR>(s.utf16()), reinterpret_cast<LPCLSID>(&u)
@@ -46,7 +47,7 @@ Invalid CLSID: '%1'
 )")
                          .arg(spec.clsid_input)
                          .trimmed();
-      QMessageBox::warning(nullptr, QCoreApplication::applicationName(), text);
+      Diagnostics::Warning(text);
     }
   }
   if (parts.size() > 1 && !parts[1].isEmpty()) {
@@ -60,7 +61,7 @@ Invalid CLSID: '%1'
 )")
                          .arg(spec.alias_input)
                          .trimmed();
-      QMessageBox::warning(nullptr, QCoreApplication::applicationName(), text);
+      Diagnostics::Warning(text);
     }
   }
   if (parts.size() > 2 && !parts[2].isEmpty()) {
@@ -85,6 +86,10 @@ Invalid CLSID: '%1'
       spec.regcls_explicit = true;
     }
   }
+  if (parts.size() > 5 && !parts[5].isEmpty()) {
+    spec.options_input = parts[5].trimmed();
+    spec.options = ClassOptions::fromString(spec.options_input);
+  }
   return spec;
 }
 
@@ -120,5 +125,9 @@ std::istream &operator>>(std::istream &is, ClassSpec &out) {
 std::ostream &operator<<(std::ostream &os, const ClassSpec &s) {
   os << s.clsid_input.toStdString() << "/" << s.alias_input.toStdString() << "/"
      << s.clsctx_create << "/" << s.clsctx_register << "/" << s.regcls;
+  QString options = s.options.toString();
+  if (!options.isEmpty()) {
+    os << "/" << options.toStdString();
+  }
   return os;
 }
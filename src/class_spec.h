@@ -26,6 +26,8 @@
 #include <QString>
 #include <QUuid>
 
+#include "class_options.h"
+
 class ClassSpec {
 public:
   QUuid clsid;
@@ -36,6 +38,8 @@ public:
   DWORD clsctx_register = 0;
   DWORD regcls = 0;
   bool regcls_explicit = false;
+  QString options_input;
+  ClassOptions options;
   HRESULT result = 0;
   DWORD error = 0;
 
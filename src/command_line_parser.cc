@@ -109,12 +109,13 @@ CommandLineParser::CommandLineParser()
   standalone
       ->add_option(
           "--clsid", m_result.specs, R"(Register a COM class (repeatable).
-            Format: c[/a[/cc[/cr[/r]]]] where
+            Format: c[/a[/cc[/cr[/r[/o]]]]] where
             - c  = CLSID
             - a  = alias CLSID
             - cc = CLSCTX for Create (DWORD)
             - cr = CLSCTX for Register (DWORD)
             - r  = REGCLS (DWORD)
+            - o  = class options (key=value[,key=value...])
             Use decimal or 0x-prefixed hex for DWORD values.
             Omit a field ("//") to keep its default:
             - a=c,
@@ -125,10 +126,25 @@ CommandLineParser::CommandLineParser()
             - REGCLS_SUSPENDED is added automatically during registration when applicable.
             - Explicitly specifying 'r' bypasses all defaults and global flags; your value is used exactly as provided.
             - Multiple-use mode avoids self-instantiation by re-registering the original InProc when available. Explicit alias recommended.
+            Class options:
+            - apartment=main|dedicated|sharded|free|auto : host the controls on the main thread (default), on a thread of their own with its own STA and message pump, or spread over a pool of such threads. free creates the object in the MTA without a control container; auto does so for non-control classes registered with ThreadingModel=Both or Free.
+            - shards=<n> : number of STA threads with apartment=sharded (default=0, one per logical processor).
+            - placement=least-loaded|round-robin : put a new instance on the shard with the fewest live instances (default), or on the next shard in turn.
+            - delivery=pooled|ordered : event delivery through the shared thread pool (default), or through a dedicated thread per connection in FIFO order.
+            - events=sync|async : with async, events without a result and with by-value arguments only are copied and queued, and the control is not blocked.
+            - queue=<n> : capacity of the per-connection event queue (default=1024, max=65536).
+            - overflow=block|drop-oldest|drop-newest : what an async event does when the queue is full (default=block).
+            - coalesce=<dispid>[:<dispid>...] : async events with these DISPIDs replace the arguments of a still pending event with the same DISPID.
+            - prewarm=<n> : number of controls created ahead of time and handed over on activation (default=0).
+            - recycle=<n> : reset released controls and reuse each of them up to n times (default=0, disabled).
+            - recycle-idle=<seconds> : how long a recycled control is kept before it is destroyed (default=300).
+            - reset=<method> : method (name or DISPID) that resets a control for reuse, instead of IPersistStreamInit::InitNew.
+            - profile=on|off : time every IDispatch::Invoke on the control and report p50/p99/p999 latencies per method (default=off).
             Examples:
             - {CLSID}/{ALIAS}
             - {CLSID}/{ALIAS}/0x1/0x4/0x2
-            - {CLSID}//0x1//0x2)"
+            - {CLSID}//0x1//0x2
+            - {CLSID}/////delivery=ordered)"
       )
       ->type_name("<item>")
       ->expected(-1);
@@ -150,6 +166,53 @@ CommandLineParser::CommandLineParser()
       ->transform(as_duration)
       ->group("");
 
+  standalone
+      ->add_option(
+          "--idle-policy", m_result.idlePolicy,
+          "When to exit once no object is in use: 'fixed' waits for the "
+          "timeout (default), 'hysteresis' also stays while the last "
+          "activation is within the idle window, 'keep-warm' never exits "
+          "when idle, 'exit-on-last-release' exits as soon as the last object "
+          "is released."
+      )
+      ->type_name("<policy>")
+      ->check(CLI::IsMember(
+          {"fixed", "hysteresis", "keep-warm", "exit-on-last-release"}
+      ));
+  standalone->add_option("-IdlePolicy", m_result.idlePolicy)
+      ->type_name("<policy>")
+      ->check(CLI::IsMember(
+          {"fixed", "hysteresis", "keep-warm", "exit-on-last-release"}
+      ))
+      ->group("");
+
+  standalone
+      ->add_option(
+          "--idle-window", m_result.idleWindow,
+          "Window for the 'hysteresis' idle policy (in milliseconds if no "
+          "unit is specified, default=300000)."
+      )
+      ->type_name(as_duration_desc)
+      ->transform(as_duration);
+  standalone->add_option("-IdleWindow", m_result.idleWindow)
+      ->type_name(as_duration_desc)
+      ->transform(as_duration)
+      ->group("");
+
+  standalone
+      ->add_option(
+          "--unload-idle", m_result.unloadIdle,
+          "Only let COM unload unused DLLs after no activation has occurred "
+          "for the given time (in milliseconds if no unit is specified, "
+          "default=60000). Frequently used DLLs are kept loaded."
+      )
+      ->type_name(as_duration_desc)
+      ->transform(as_duration);
+  standalone->add_option("-UnloadIdle", m_result.unloadIdle)
+      ->type_name(as_duration_desc)
+      ->transform(as_duration)
+      ->group("");
+
   standalone
       ->add_option(
           "--ready-event", m_result.readyEvent,
@@ -161,6 +224,50 @@ CommandLineParser::CommandLineParser()
       ->type_name("<name>")
       ->group("");
 
+  standalone
+      ->add_option(
+          "--pool-size", m_result.poolSize,
+          "Act as a supervisor that keeps the given number of single-use "
+          "children with the same options ready to be activated, and starts "
+          "a new one whenever a child has been activated. The ready event is "
+          "signaled once the first children are ready."
+      )
+      ->type_name("<n>")
+      ->check(CLI::NonNegativeNumber);
+  standalone->add_option("-PoolSize", m_result.poolSize)
+      ->type_name("<n>")
+      ->check(CLI::NonNegativeNumber)
+      ->group("");
+  standalone->add_option("--pool-child", m_result.poolChild)->group("");
+
+  standalone
+      ->add_option(
+          "--workers", m_result.workers,
+          "Act as a front that registers the classes and forwards every "
+          "activation to one of the given number of multiple-use worker "
+          "processes. Workers that exit are replaced."
+      )
+      ->type_name("<n>")
+      ->check(CLI::NonNegativeNumber);
+  standalone->add_option("-Workers", m_result.workers)
+      ->type_name("<n>")
+      ->check(CLI::NonNegativeNumber)
+      ->group("");
+
+  standalone
+      ->add_option(
+          "--balance", m_result.balance,
+          "How the front picks a worker: 'pending' (fewest activations in "
+          "flight, default) or 'latency' (lowest recent activation time)."
+      )
+      ->type_name("<policy>")
+      ->check(CLI::IsMember({"pending", "latency"}));
+  standalone->add_option("-Balance", m_result.balance)
+      ->type_name("<policy>")
+      ->check(CLI::IsMember({"pending", "latency"}))
+      ->group("");
+  standalone->add_option("--farm-worker", m_result.farmWorker)->group("");
+
   auto single_use_callback = [&]() { m_result.regcls = REGCLS_SINGLEUSE; };
   auto multiple_use_callback = [&]() { m_result.regcls = REGCLS_MULTIPLEUSE; };
 
@@ -180,6 +287,113 @@ CommandLineParser::CommandLineParser()
   standalone->add_flag_callback("-MultipleUse", multiple_use_callback)
       ->group("");
 
+  standalone
+      ->add_option(
+          "--coalesce", m_result.coalesce,
+          "DISPIDs of events that may be coalesced for every class "
+          "(repeatable, comma separated). Requires events=async in the class "
+          "options."
+      )
+      ->type_name("<dispid>")
+      ->delimiter(',');
+  standalone->add_option("-Coalesce", m_result.coalesce)
+      ->type_name("<dispid>")
+      ->delimiter(',')
+      ->group("");
+
+  standalone
+      ->add_option(
+          "--coalesce-file", m_result.coalesceFile,
+          "Read coalescible DISPIDs from a file, one or more per line. Text "
+          "after '#' is ignored."
+      )
+      ->type_name("<file>");
+  standalone->add_option("-CoalesceFile", m_result.coalesceFile)
+      ->type_name("<file>")
+      ->group("");
+
+  standalone->add_flag(
+      "--interactive", m_result.interactive,
+      "Show errors and warnings in message boxes. By default they are only "
+      "logged, so that an unattended host never blocks on a dialog."
+  );
+  standalone->add_flag("-Interactive", m_result.interactive)->group("");
+
+  standalone
+      ->add_option(
+          "--dump-flight-record", m_result.dumpFlightRecord,
+          "Ask the axhost process with the given PID to write its flight "
+          "recorder, the last trace events of every thread, next to its log "
+          "files."
+      )
+      ->type_name("<pid>");
+  standalone->add_option("-DumpFlightRecord", m_result.dumpFlightRecord)
+      ->type_name("<pid>")
+      ->group("");
+
+  standalone
+      ->add_option(
+          "--stats", m_result.stats,
+          "Print the live statistics the axhost process with the given PID "
+          "publishes in shared memory, without making COM calls into it."
+      )
+      ->type_name("<pid>");
+  standalone->add_option("-Stats", m_result.stats)
+      ->type_name("<pid>")
+      ->group("");
+
+  standalone
+      ->add_option(
+          "--decode-flight-record", m_result.decodeFlightRecord,
+          "Decode a flight recorder dump into a text file next to it."
+      )
+      ->type_name("<file>");
+  standalone->add_option("-DecodeFlightRecord", m_result.decodeFlightRecord)
+      ->type_name("<file>")
+      ->group("");
+
+  standalone->add_flag(
+      "--fast-start", m_result.fastStart,
+      "Skip startup work a headless host does not need: the command line is "
+      "parsed only once and the preferred UI languages are left alone."
+  );
+  standalone->add_flag("-FastStart", m_result.fastStart)->group("");
+
+  standalone
+      ->add_option(
+          "--startup-timeline", m_result.startupTimeline,
+          "Write the duration of each startup phase to the given JSON file. "
+          "The timeline is always written to the log."
+      )
+      ->type_name("<file>");
+  standalone->add_option("-StartupTimeline", m_result.startupTimeline)
+      ->type_name("<file>")
+      ->group("");
+
+  standalone
+      ->add_option(
+          "--profile-interval", m_result.profileInterval,
+          "Seconds between reports of Invoke latencies for classes with "
+          "profile=on (default=60). 0 reports only on exit."
+      )
+      ->type_name("<seconds>")
+      ->check(CLI::NonNegativeNumber);
+  standalone->add_option("-ProfileInterval", m_result.profileInterval)
+      ->type_name("<seconds>")
+      ->check(CLI::NonNegativeNumber)
+      ->group("");
+
+  standalone
+      ->add_option(
+          "--profile-file", m_result.profileFile,
+          "Append each Invoke latency report as a JSON line to the given "
+          "file. '{pid}' is replaced with the process id."
+      )
+      ->type_name("<file>");
+  standalone->add_option("-ProfileFile", m_result.profileFile)
+      ->type_name("<file>")
+      ->group("");
+
   standalone->add_flag(
       "--enable-logging", m_result.enableLogging,
       "Enable logging for this process."
@@ -217,6 +431,77 @@ CommandLineParser::CommandLineParser()
       ->type_name("<dir>")
       ->group("");
 
+  standalone->add_flag(
+      "--log-async", m_result.logAsync,
+      "Queue log messages and write them on a background thread, so that "
+      "logging does not block COM calls."
+  );
+  standalone->add_flag("-LogAsync", m_result.logAsync)->group("");
+
+  standalone
+      ->add_option(
+          "--log-queue", m_result.logQueue,
+          "Capacity of the async log queue in messages (default=8192)."
+      )
+      ->type_name("<n>")
+      ->check(CLI::PositiveNumber);
+  standalone->add_option("-LogQueue", m_result.logQueue)
+      ->type_name("<n>")
+      ->check(CLI::PositiveNumber)
+      ->group("");
+
+  standalone
+      ->add_option(
+          "--log-overflow", m_result.logOverflow,
+          "What a message does when the async log queue is full: 'block' "
+          "(default), 'drop-oldest' or 'drop-newest'."
+      )
+      ->type_name("<policy>")
+      ->check(CLI::IsMember({"block", "drop-oldest", "drop-newest"}));
+  standalone->add_option("-LogOverflow", m_result.logOverflow)
+      ->type_name("<policy>")
+      ->check(CLI::IsMember({"block", "drop-oldest", "drop-newest"}))
+      ->group("");
+
+  standalone
+      ->add_option(
+          "--log-max-size", m_result.logMaxSize,
+          "Rotate the log file when it reaches this many megabytes "
+          "(default=0, unlimited)."
+      )
+      ->type_name("<mb>")
+      ->check(CLI::NonNegativeNumber);
+  standalone->add_option("-LogMaxSize", m_result.logMaxSize)
+      ->type_name("<mb>")
+      ->check(CLI::NonNegativeNumber)
+      ->group("");
+
+  standalone
+      ->add_option(
+          "--log-max-files", m_result.logMaxFiles,
+          "Number of rotated log files kept next to the current one "
+          "(default=3). Requires --log-max-size."
+      )
+      ->type_name("<n>")
+      ->check(CLI::NonNegativeNumber);
+  standalone->add_option("-LogMaxFiles", m_result.logMaxFiles)
+      ->type_name("<n>")
+      ->check(CLI::NonNegativeNumber)
+      ->group("");
+
+  standalone
+      ->add_option(
+          "--log-retention", m_result.logRetention,
+          "Delete log files older than this many days from the log directory "
+          "at startup (default=0, keep all)."
+      )
+      ->type_name("<days>")
+      ->check(CLI::NonNegativeNumber);
+  standalone->add_option("-LogRetention", m_result.logRetention)
+      ->type_name("<days>")
+      ->check(CLI::NonNegativeNumber)
+      ->group("");
+
   auto registry = m_app.add_option_group(
       "Registry",
       "Options used to configure or remove registry entries required for "
@@ -284,6 +569,45 @@ CommandLineParser::CommandLineParser()
       ->type_name("<dir>")
       ->group("");
 
+  registry
+      ->add_option(
+          "--register-log-max-size", m_result.registerLogMaxSize,
+          "Log file size in megabytes after which surrogate instances rotate "
+          "their log. Requires --register."
+      )
+      ->type_name("<mb>")
+      ->check(CLI::NonNegativeNumber);
+  registry->add_option("-RegisterLogMaxSize", m_result.registerLogMaxSize)
+      ->type_name("<mb>")
+      ->check(CLI::NonNegativeNumber)
+      ->group("");
+
+  registry
+      ->add_option(
+          "--register-log-max-files", m_result.registerLogMaxFiles,
+          "Number of rotated log files surrogate instances keep (default=3). "
+          "Requires --register-log-max-size."
+      )
+      ->type_name("<n>")
+      ->check(CLI::NonNegativeNumber);
+  registry->add_option("-RegisterLogMaxFiles", m_result.registerLogMaxFiles)
+      ->type_name("<n>")
+      ->check(CLI::NonNegativeNumber)
+      ->group("");
+
+  registry
+      ->add_option(
+          "--register-log-retention", m_result.registerLogRetention,
+          "Days after which surrogate instances delete old log files from "
+          "the log directory. Requires --register."
+      )
+      ->type_name("<days>")
+      ->check(CLI::NonNegativeNumber);
+  registry->add_option("-RegisterLogRetention", m_result.registerLogRetention)
+      ->type_name("<days>")
+      ->check(CLI::NonNegativeNumber)
+      ->group("");
+
   registry
       ->add_option(
           "--unregister", m_result.unregisterClassId,
@@ -19,6 +19,9 @@
 #ifndef COMMAND_LINE_PARSER_H
 #define COMMAND_LINE_PARSER_H
 
+#include <string>
+#include <vector>
+
 #include <CLI/CLI.hpp>
 
 #include <QList>
@@ -37,13 +40,39 @@ struct ParsedResult {
 
   QList<ClassSpec> specs;
   int timeout = 60000;
+  QString idlePolicy;
+  int idleWindow = 300000;
+  int unloadIdle = 60000;
   QString readyEvent;
   DWORD regcls = 0;
+  int poolSize = 0;
+  QString poolChild;
+  int workers = 0;
+  QString balance = "pending";
+  QString farmWorker;
+
+  std::vector<std::string> coalesce;
+  QString coalesceFile;
+
+  bool interactive = false;
+  bool fastStart = false;
+  DWORD dumpFlightRecord = 0;
+  DWORD stats = 0;
+  QString decodeFlightRecord;
+  QString startupTimeline;
+  int profileInterval = 60;
+  QString profileFile;
 
   bool enableLogging = false;
   QString logLevel;
   QString logFile;
   QString logDir;
+  bool logAsync = false;
+  int logQueue = 8192;
+  QString logOverflow = "block";
+  int logMaxSize = 0;
+  int logMaxFiles = 3;
+  int logRetention = 0;
 
   QString registerClassId;
   QString registerAppId;
@@ -52,6 +81,9 @@ struct ParsedResult {
   bool registerLogging = false;
   QString registerLogLevel;
   QString registerLogDir;
+  int registerLogMaxSize = 0;
+  int registerLogMaxFiles = 3;
+  int registerLogRetention = 0;
 
   int code = 0;
   QString msg;
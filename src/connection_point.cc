@@ -52,6 +52,10 @@ HostConnectionPoint::GetUnderlyingSink(DWORD dwCookie, IUnknown **ppUnk) {
   return S_OK;
 }
 
+bool HostConnectionPoint::HasConnections() const {
+  return !m_connections.empty();
+}
+
 HRESULT STDMETHODCALLTYPE
 HostConnectionPoint::GetConnectionInterface(IID *pIID) {
   if (!pIID)
@@ -77,7 +81,7 @@ HRESULT STDMETHODCALLTYPE
 HostConnectionPoint::Advise(IUnknown *pUnkSink, DWORD *pdwCookie) {
   if (!pUnkSink || !pdwCookie)
     return E_INVALIDARG;
-  CComPtr<HostEventSink> proxyConcrete = new HostEventSink(pUnkSink);
+  CComPtr<HostEventSink> proxyConcrete = new HostEventSink(pUnkSink, m_container->GetOptions());
   if (!proxyConcrete) {
     return E_OUTOFMEMORY;
   }
@@ -43,6 +43,7 @@ public:
 
 public:
   HRESULT GetUnderlyingSink(DWORD dwCookie, IUnknown **ppUnk);
+  bool HasConnections() const;
 
 public:
   HRESULT STDMETHODCALLTYPE GetConnectionInterface(IID *pIID) override;
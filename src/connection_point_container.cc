@@ -22,9 +22,23 @@
 #include "enum_connection_points.h"
 
 HostConnectionPointContainer::HostConnectionPointContainer(
-    IConnectionPointContainer *underlying
+    IConnectionPointContainer *underlying, const ClassOptions &options
 )
-    : m_underlying(underlying) {}
+    : m_underlying(underlying),
+      m_options(options) {}
+
+const ClassOptions &HostConnectionPointContainer::GetOptions() const {
+  return m_options;
+}
+
+bool HostConnectionPointContainer::HasConnections() const {
+  for (const auto &[underlying, proxy] : m_proxyConnectionPoints) {
+    // Every proxy in the map was created by GetProxyConnectionPoint.
+    if (static_cast<HostConnectionPoint *>(proxy.p)->HasConnections())
+      return true;
+  }
+  return false;
+}
 
 HRESULT HostConnectionPointContainer::GetProxyConnectionPoint(
     IUnknown *pCP, IConnectionPoint **ppCP
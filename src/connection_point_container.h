@@ -23,19 +23,25 @@
 
 #include <atlcomcli.h>
 
+#include "class_options.h"
 #include "unknown_impl.h"
 
 class HostConnectionPointContainer
     : public CUnknownImpl<IConnectionPointContainer> {
 private:
   CComPtr<IConnectionPointContainer> m_underlying;
+  ClassOptions m_options;
   std::unordered_map<IUnknown *, CComPtr<IConnectionPoint>>
       m_proxyConnectionPoints;
 
 public:
-  HostConnectionPointContainer(IConnectionPointContainer *underlying);
+  HostConnectionPointContainer(
+      IConnectionPointContainer *underlying, const ClassOptions &options
+  );
 
 public:
+  const ClassOptions &GetOptions() const;
+  bool HasConnections() const;
   HRESULT GetProxyConnectionPoint(IUnknown *pCP, IConnectionPoint **ppCP);
 
 public:
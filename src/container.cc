@@ -18,53 +18,55 @@
 
 #include "container.h"
 
+#include <string>
+
 #include <windows.h>
 
 #include <atlcomcli.h>
 #include <ocidl.h>
 #include <oleidl.h>
+#include <wil/result.h>
 
+#include <QAxObject>
 #include <QAxWidget>
 #include <QCoreApplication>
-#include <QMessageBox>
 #include <QSharedPointer>
 #include <QString>
+#include <QThread>
 #include <QUuid>
 
+#include "apartment_thread.h"
 #include "connection_point_container.h"
+#include "container_pool.h"
+#include "diagnostics.h"
+#include "dispatch_profiler.h"
 #include "external_connection.h"
+#include "flight_recorder.h"
 #include "provide_class_info.h"
 #include "surrogate_runtime.h"
 #include "utils.h"
 
-HostContainer::HostContainer(REFCLSID clsid, DWORD clsctx)
+HostContainer::HostContainer(
+    REFCLSID clsid, DWORD clsctx, const ClassOptions &options, bool pooled
+)
     : m_classId(clsid),
       m_classContext(clsctx),
-      m_control(new QAxWidget()) {
-  if (auto *runtime = HostSurrogateRuntime::instance()) {
-    runtime->AddServerReference();
+      m_options(options) {
+  // Widgets can only live on the GUI thread. Controls created in another
+  // apartment are hosted without a window.
+  if (QThread::currentThread() == QCoreApplication::instance()->thread()) {
+    m_control.reset(new QAxWidget());
+  } else {
+    m_control.reset(new QAxObject());
+  }
+  if (!pooled) {
+    AcquireServerReference();
   }
   m_control->setClassContext(m_classContext);
 
-  if (m_control->setControl(m_classId.toString()) && !m_control->isNull()) {
-    CComPtr<IProvideClassInfo> underlyingPCI;
-    CComPtr<IProvideClassInfo2> underlyingPCI2;
-    m_control->queryInterface(IID_IProvideClassInfo, (void **)&underlyingPCI);
-    m_control->queryInterface(IID_IProvideClassInfo2, (void **)&underlyingPCI2);
-    m_provideClassInfo =
-        new HostProvideClassInfo(m_classId, underlyingPCI, underlyingPCI2);
-
-    CComPtr<IConnectionPointContainer> underlyingCPC;
-    m_control->queryInterface(
-        IID_IConnectionPointContainer, (void **)&underlyingCPC
-    );
-    m_connectionPointContainer =
-        new HostConnectionPointContainer(underlyingCPC);
-
-    CComPtr<IExternalConnection> underlyingEC;
-    m_control->queryInterface(IID_IExternalConnection, (void **)&underlyingEC);
-    m_externalConnection = new HostExternalConnection(underlyingEC);
-  } else {
+  ++g_containerCount;
+  ++g_liveContainerCount;
+  if (!m_control->setControl(m_classId.toString()) || m_control->isNull()) {
     DWORD err = GetLastError();
     QString classId = m_classId.toString();
     QString classContext = QString::number(m_classContext, 16);
@@ -83,25 +85,186 @@ Error message:
                        .arg(classContext)
                        .arg(errorMessage)
                        .trimmed();
-    QMessageBox::critical(nullptr, QCoreApplication::applicationName(), text);
+    Diagnostics::Error(text);
   }
 }
 
+std::atomic<quint64> HostContainer::g_containerCount{0};
+std::atomic<uint64_t> HostContainer::g_wrapperCount{0};
+std::atomic<quint64> HostContainer::g_liveContainerCount{0};
+
 HostContainer::~HostContainer() {
-  if (auto *runtime = HostSurrogateRuntime::instance()) {
-    runtime->ReleaseServerReference();
+  --g_liveContainerCount;
+  if (QSharedPointer<HostApartmentThread> apartment =
+          m_apartment.toStrongRef()) {
+    apartment->ReleaseInstance();
   }
+  ReleaseServerReference();
 }
 
 bool HostContainer::IsInitialized() {
   return m_control && !m_control->isNull();
 }
 
-ULONG STDMETHODCALLTYPE HostContainer::AddRef() { return ++m_ref; }
+void HostContainer::AcquireServerReference() {
+  if (m_holdsServerReference)
+    return;
+  m_holdsServerReference = true;
+  if (auto *runtime = HostSurrogateRuntime::instance()) {
+    runtime->AddServerReference();
+  }
+}
+
+void HostContainer::ReleaseServerReference() {
+  if (!m_holdsServerReference)
+    return;
+  m_holdsServerReference = false;
+  if (auto *runtime = HostSurrogateRuntime::instance()) {
+    runtime->ReleaseServerReference();
+  }
+}
+
+void HostContainer::SetPool(HostContainerPool *pool) { m_pool = pool; }
+
+void HostContainer::SetApartment(
+    const QWeakPointer<HostApartmentThread> &apartment
+) {
+  // Counted for as long as the container lives; it never changes threads.
+  m_apartment = apartment;
+  if (QSharedPointer<HostApartmentThread> thread = m_apartment.toStrongRef()) {
+    thread->AddInstance();
+  }
+}
+
+int HostContainer::GetReuseCount() const { return m_reuseCount; }
+
+// The wrappers below are created on first use. Most clients never ask for
+// class info or connection points, so the control is only queried for the
+// underlying interfaces when they do.
+
+HostProvideClassInfo *HostContainer::GetProvideClassInfo() {
+  return m_provideClassInfo.Get([this] {
+    CComPtr<IProvideClassInfo> underlyingPCI;
+    CComPtr<IProvideClassInfo2> underlyingPCI2;
+    if (IsInitialized()) {
+      m_control->queryInterface(IID_IProvideClassInfo, (void **)&underlyingPCI);
+      m_control->queryInterface(
+          IID_IProvideClassInfo2, (void **)&underlyingPCI2
+      );
+    }
+    return CComPtr<HostProvideClassInfo>(
+        new HostProvideClassInfo(m_classId, underlyingPCI, underlyingPCI2)
+    );
+  });
+}
+
+HostConnectionPointContainer *HostContainer::GetConnectionPointContainer() {
+  return m_connectionPointContainer.Get([this] {
+    CComPtr<IConnectionPointContainer> underlyingCPC;
+    if (IsInitialized()) {
+      m_control->queryInterface(
+          IID_IConnectionPointContainer, (void **)&underlyingCPC
+      );
+    }
+    return CComPtr<HostConnectionPointContainer>(
+        new HostConnectionPointContainer(underlyingCPC, m_options)
+    );
+  });
+}
+
+HostExternalConnection *HostContainer::GetExternalConnection() {
+  return m_externalConnection.Get([this] {
+    CComPtr<IExternalConnection> underlyingEC;
+    if (IsInitialized()) {
+      m_control->queryInterface(
+          IID_IExternalConnection, (void **)&underlyingEC
+      );
+    }
+    return CComPtr<HostExternalConnection>(
+        new HostExternalConnection(underlyingEC)
+    );
+  });
+}
+
+// Only created for classes with profile=on. Without it, IDispatch is the
+// control's own and calls never pass through the host.
+HostDispatchProfiler *HostContainer::GetDispatchProfiler() {
+  return m_dispatchProfiler.Get([this] {
+    CComPtr<HostDispatchProfiler> profiler;
+    CComPtr<IDispatch> underlyingDispatch;
+    if (IsInitialized()) {
+      m_control->queryInterface(IID_IDispatch, (void **)&underlyingDispatch);
+    }
+    if (underlyingDispatch) {
+      profiler = new HostDispatchProfiler(m_classId, underlyingDispatch);
+    }
+    return profiler;
+  });
+}
+
+quint64 HostContainer::GetContainerCount() { return g_containerCount; }
+
+quint64 HostContainer::GetWrapperCount() { return g_wrapperCount; }
+
+quint64 HostContainer::GetLiveContainerCount() {
+  return g_liveContainerCount;
+}
+
+bool HostContainer::HasConnections() const {
+  const CComPtr<HostConnectionPointContainer> &container =
+      m_connectionPointContainer.Peek();
+  return container && container->HasConnections();
+}
+
+HRESULT HostContainer::Reset() {
+  if (!IsInitialized())
+    return E_UNEXPECTED;
+  if (m_options.reset.isEmpty()) {
+    CComPtr<IPersistStreamInit> persist;
+    m_control->queryInterface(IID_IPersistStreamInit, (void **)&persist);
+    if (!persist)
+      return E_NOINTERFACE;
+    RETURN_IF_FAILED(persist->InitNew());
+  } else {
+    CComPtr<IDispatch> dispatch;
+    m_control->queryInterface(IID_IDispatch, (void **)&dispatch);
+    if (!dispatch)
+      return E_NOINTERFACE;
+    bool ok = false;
+    DISPID dispId = m_options.reset.toInt(&ok, 0);
+    if (!ok) {
+      std::wstring name = m_options.reset.toStdWString();
+      LPOLESTR names[] = {name.data()};
+      RETURN_IF_FAILED(dispatch->GetIDsOfNames(
+          IID_NULL, names, 1, LOCALE_USER_DEFAULT, &dispId
+      ));
+    }
+    DISPPARAMS params = {nullptr, nullptr, 0, 0};
+    RETURN_IF_FAILED(dispatch->Invoke(
+        dispId, IID_NULL, LOCALE_USER_DEFAULT, DISPATCH_METHOD, &params,
+        nullptr, nullptr, nullptr
+    ));
+  }
+  ++m_reuseCount;
+  return S_OK;
+}
+
+ULONG STDMETHODCALLTYPE HostContainer::AddRef() {
+  ULONG n = ++m_ref;
+  FlightRecorder::Record(
+      FlightEvent::ContainerAddRef, reinterpret_cast<uintptr_t>(this), n
+  );
+  return n;
+}
 
 ULONG STDMETHODCALLTYPE HostContainer::Release() {
   ULONG n = --m_ref;
+  FlightRecorder::Record(
+      FlightEvent::ContainerRelease, reinterpret_cast<uintptr_t>(this), n
+  );
   if (n <= 0) {
+    if (m_pool && m_pool->Recycle(this))
+      return 0;
     delete this;
   }
   return n;
@@ -115,13 +278,25 @@ HostContainer::QueryInterface(REFIID riid, void **ppv) {
   if (riid == IID_IUnknown) {
     *ppv = static_cast<IProvideClassInfo2 *>(this);
   } else if (riid == IID_IProvideClassInfo2) {
+    if (!GetProvideClassInfo())
+      return E_OUTOFMEMORY;
     *ppv = static_cast<IProvideClassInfo2 *>(this);
   } else if (riid == IID_IProvideClassInfo) {
+    if (!GetProvideClassInfo())
+      return E_OUTOFMEMORY;
     *ppv = static_cast<IProvideClassInfo *>(this);
   } else if (riid == IID_IConnectionPointContainer) {
+    if (!GetConnectionPointContainer())
+      return E_OUTOFMEMORY;
     *ppv = static_cast<IConnectionPointContainer *>(this);
   } else if (riid == IID_IExternalConnection) {
+    if (!GetExternalConnection())
+      return E_OUTOFMEMORY;
     *ppv = static_cast<IExternalConnection *>(this);
+  } else if (riid == IID_IDispatch && m_options.profile) {
+    if (!GetDispatchProfiler())
+      return E_NOINTERFACE;
+    *ppv = static_cast<IDispatch *>(this);
   } else {
     if (!m_control || m_control->isNull())
       return E_NOINTERFACE;
@@ -132,33 +307,61 @@ HostContainer::QueryInterface(REFIID riid, void **ppv) {
 }
 
 HRESULT STDMETHODCALLTYPE HostContainer::GetClassInfo(ITypeInfo **ppTI) {
-  return m_provideClassInfo->GetClassInfo(ppTI);
+  return GetProvideClassInfo()->GetClassInfo(ppTI);
 }
 
 HRESULT STDMETHODCALLTYPE
 HostContainer::GetGUID(DWORD dwGuidKind, GUID *pGUID) {
-  return m_provideClassInfo->GetGUID(dwGuidKind, pGUID);
+  return GetProvideClassInfo()->GetGUID(dwGuidKind, pGUID);
 }
 
 HRESULT STDMETHODCALLTYPE
 HostContainer::EnumConnectionPoints(IEnumConnectionPoints **ppEnum) {
-  return m_connectionPointContainer->EnumConnectionPoints(ppEnum);
+  return GetConnectionPointContainer()->EnumConnectionPoints(ppEnum);
 }
 
 HRESULT STDMETHODCALLTYPE
 HostContainer::FindConnectionPoint(REFIID riid, IConnectionPoint **ppCP) {
-  return m_connectionPointContainer->FindConnectionPoint(riid, ppCP);
+  return GetConnectionPointContainer()->FindConnectionPoint(riid, ppCP);
 }
 
 DWORD STDMETHODCALLTYPE
 HostContainer::AddConnection(DWORD extconn, DWORD reserved) {
-  return m_externalConnection->AddConnection(extconn, reserved);
+  return GetExternalConnection()->AddConnection(extconn, reserved);
 }
 
 DWORD STDMETHODCALLTYPE HostContainer::ReleaseConnection(
     DWORD extconn, DWORD reserved, BOOL fLastReleaseCloses
 ) {
-  return m_externalConnection->ReleaseConnection(
+  return GetExternalConnection()->ReleaseConnection(
       extconn, reserved, fLastReleaseCloses
   );
 }
+
+HRESULT STDMETHODCALLTYPE HostContainer::GetTypeInfoCount(UINT *pctinfo) {
+  return GetDispatchProfiler()->GetTypeInfoCount(pctinfo);
+}
+
+HRESULT STDMETHODCALLTYPE
+HostContainer::GetTypeInfo(UINT iTInfo, LCID lcid, ITypeInfo **ppTInfo) {
+  return GetDispatchProfiler()->GetTypeInfo(iTInfo, lcid, ppTInfo);
+}
+
+HRESULT STDMETHODCALLTYPE HostContainer::GetIDsOfNames(
+    REFIID riid, LPOLESTR *rgszNames, UINT cNames, LCID lcid, DISPID *rgDispId
+) {
+  return GetDispatchProfiler()->GetIDsOfNames(
+      riid, rgszNames, cNames, lcid, rgDispId
+  );
+}
+
+HRESULT STDMETHODCALLTYPE HostContainer::Invoke(
+    DISPID dispIdMember, REFIID riid, LCID lcid, WORD wFlags,
+    DISPPARAMS *pDispParams, VARIANT *pVarResult, EXCEPINFO *pExcepInfo,
+    UINT *puArgErr
+) {
+  return GetDispatchProfiler()->Invoke(
+      dispIdMember, riid, lcid, wFlags, pDispParams, pVarResult, pExcepInfo,
+      puArgErr
+  );
+}
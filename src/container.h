@@ -20,6 +20,7 @@
 #define CONTAINER_H
 
 #include <atomic>
+#include <cstdint>
 
 #include <windows.h>
 
@@ -27,35 +28,87 @@
 #include <ocidl.h>
 #include <oleidl.h>
 
-#include <QAxWidget>
+#include <QAxBase>
+#include <QPointer>
 #include <QSharedPointer>
 #include <QUuid>
 
+#include "class_options.h"
 #include "connection_point_container.h"
+#include "dispatch_profiler.h"
 #include "external_connection.h"
+#include "lazy_member.h"
 #include "provide_class_info.h"
 
+class HostApartmentThread;
+class HostContainerPool;
+
 class HostContainer : public IProvideClassInfo2,
                       public IConnectionPointContainer,
-                      public IExternalConnection {
+                      public IExternalConnection,
+                      public IDispatch {
 private:
   std::atomic<ULONG> m_ref{0};
 
   QUuid m_classId;
   DWORD m_classContext;
+  ClassOptions m_options;
+
+  bool m_holdsServerReference = false;
+
+  QPointer<HostContainerPool> m_pool;
+  int m_reuseCount = 0;
+
+  // Weak, since the thread must not be destroyed by a container running
+  // on it; the factory owns its threads.
+  QWeakPointer<HostApartmentThread> m_apartment;
 
-  QSharedPointer<QAxWidget> m_control;
+  QSharedPointer<QAxBase> m_control;
 
-  CComPtr<HostProvideClassInfo> m_provideClassInfo;
-  CComPtr<HostConnectionPointContainer> m_connectionPointContainer;
-  CComPtr<HostExternalConnection> m_externalConnection;
+  static std::atomic<quint64> g_containerCount;
+  static std::atomic<uint64_t> g_wrapperCount;
+  static std::atomic<quint64> g_liveContainerCount;
+
+  LazyMember<CComPtr<HostProvideClassInfo>> m_provideClassInfo{
+      &g_wrapperCount
+  };
+  LazyMember<CComPtr<HostConnectionPointContainer>> m_connectionPointContainer{
+      &g_wrapperCount
+  };
+  LazyMember<CComPtr<HostExternalConnection>> m_externalConnection{
+      &g_wrapperCount
+  };
+  LazyMember<CComPtr<HostDispatchProfiler>> m_dispatchProfiler{
+      &g_wrapperCount
+  };
+
+  HostProvideClassInfo *GetProvideClassInfo();
+  HostConnectionPointContainer *GetConnectionPointContainer();
+  HostExternalConnection *GetExternalConnection();
+  HostDispatchProfiler *GetDispatchProfiler();
 
 public:
-  HostContainer(REFCLSID clsid, DWORD clsctx = CLSCTX_SERVER);
+  HostContainer(
+      REFCLSID clsid, DWORD clsctx = CLSCTX_SERVER,
+      const ClassOptions &options = ClassOptions(), bool pooled = false
+  );
   ~HostContainer();
 
   bool IsInitialized();
 
+  void AcquireServerReference();
+  void ReleaseServerReference();
+
+  void SetPool(HostContainerPool *pool);
+  void SetApartment(const QWeakPointer<HostApartmentThread> &apartment);
+  int GetReuseCount() const;
+  bool HasConnections() const;
+  HRESULT Reset();
+
+  static quint64 GetContainerCount();
+  static quint64 GetWrapperCount();
+  static quint64 GetLiveContainerCount();
+
   ULONG STDMETHODCALLTYPE AddRef() override;
   ULONG STDMETHODCALLTYPE Release() override;
 
@@ -73,6 +126,19 @@ public:
   DWORD STDMETHODCALLTYPE ReleaseConnection(
       DWORD extconn, DWORD reserved, BOOL fLastReleaseCloses
   ) override;
+
+  HRESULT STDMETHODCALLTYPE GetTypeInfoCount(UINT *pctinfo) override;
+  HRESULT STDMETHODCALLTYPE
+  GetTypeInfo(UINT iTInfo, LCID lcid, ITypeInfo **ppTInfo) override;
+  HRESULT STDMETHODCALLTYPE GetIDsOfNames(
+      REFIID riid, LPOLESTR *rgszNames, UINT cNames, LCID lcid,
+      DISPID *rgDispId
+  ) override;
+  HRESULT STDMETHODCALLTYPE Invoke(
+      DISPID dispIdMember, REFIID riid, LCID lcid, WORD wFlags,
+      DISPPARAMS *pDispParams, VARIANT *pVarResult, EXCEPINFO *pExcepInfo,
+      UINT *puArgErr
+  ) override;
 };
 
 #endif // CONTAINER_H
@@ -18,14 +18,52 @@
 
 #include "container_factory.h"
 
+#include <cstring>
+
 #include <wil/result.h>
 #include <windows.h>
 
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QSharedPointer>
+#include <QString>
+#include <QThread>
+
+#include "spdlog/spdlog.h"
+
 #include "class_spec.h"
 #include "container.h"
+#include "direct_object.h"
+#include "flight_recorder.h"
+#include "registry_helper.h"
 #include "surrogate_runtime.h"
 #include "unknown_impl.h"
 
+static bool IsFreeThreaded(const QUuid &clsid) {
+  // Controls need a client site even when they could run in any apartment.
+  if (IsControlClass(clsid))
+    return false;
+  QString model;
+  if (FAILED(ReadThreadingModel(clsid, &model)))
+    return false;
+  return model.compare("Both", Qt::CaseInsensitive) == 0 ||
+         model.compare("Free", Qt::CaseInsensitive) == 0;
+}
+
+MarshalerCacheCounts HostContainerFactory::g_marshalCounts;
+
+QMutex HostContainerFactory::g_factoriesMutex;
+QList<HostContainerFactory *> HostContainerFactory::g_factories;
+
+bool HostContainerFactory::MarshalKey::operator<(const MarshalKey &other
+) const {
+  int order = memcmp(&riid, &other.riid, sizeof(IID));
+  if (order != 0)
+    return order < 0;
+  return std::tie(destContext, mshlflags) <
+         std::tie(other.destContext, other.mshlflags);
+}
+
 IUnknown *HostContainerFactory::GetInterfaceToBeMarshaled(REFIID riid) {
   if (riid == IID_IClassFactory || riid == IID_IUnknown) {
     return m_unk;
@@ -36,9 +74,34 @@ IUnknown *HostContainerFactory::GetInterfaceToBeMarshaled(REFIID riid) {
   }
 }
 
-HostContainerFactory::HostContainerFactory(REFCLSID clsid, DWORD clsctx)
+HRESULT HostContainerFactory::GetStandardMarshal(
+    REFIID riid, DWORD dwDestContext, void *pvDestContext, DWORD mshlflags,
+    IMarshal **ppMarshal
+) {
+  if (!ppMarshal)
+    return E_POINTER;
+  *ppMarshal = nullptr;
+  HRESULT hr = S_OK;
+  CComPtr<IMarshal> marshal =
+      m_marshals.Find(MarshalKey{riid, dwDestContext, mshlflags}, [&] {
+        CComPtr<IMarshal> created;
+        hr = CoGetStandardMarshal(
+            riid, GetInterfaceToBeMarshaled(riid), dwDestContext,
+            pvDestContext, mshlflags, &created
+        );
+        return created;
+      });
+  RETURN_IF_FAILED(hr);
+  *ppMarshal = marshal.Detach();
+  return S_OK;
+}
+
+HostContainerFactory::HostContainerFactory(
+    REFCLSID clsid, DWORD clsctx, const ClassOptions &options
+)
     : m_classId(clsid),
-      m_classContext(clsctx) {
+      m_classContext(clsctx),
+      m_options(options) {
   m_unk = static_cast<IClassFactory *>(this);
 
   [&] {
@@ -57,16 +120,80 @@ HostContainerFactory::HostContainerFactory(REFCLSID clsid, DWORD clsctx)
 
     return S_OK;
   }();
+
+  if (m_options.apartment == ClassApartment::Auto) {
+    m_options.apartment = IsFreeThreaded(m_classId) ? ClassApartment::Free
+                                                    : ClassApartment::Main;
+  }
+
+  if (m_options.apartment == ClassApartment::Free) {
+    // Objects are only created on this thread. Their calls are dispatched
+    // by the RPC threads of the multithreaded apartment.
+    StartApartments(1, COINIT_MULTITHREADED);
+    if (!m_apartments.isEmpty()) {
+      m_apartments.first()->Invoke([&] {
+        return CoGetClassObject(
+            clsid, clsctx, nullptr, IID_IClassFactory,
+            (void **)&m_apartmentUnderlying
+        );
+      });
+    }
+  } else if (m_options.apartment == ClassApartment::Dedicated) {
+    StartApartments(1);
+  } else if (m_options.apartment == ClassApartment::Sharded) {
+    int count = m_options.shards;
+    if (count <= 0) {
+      count = QThread::idealThreadCount();
+    }
+    StartApartments(count);
+  } else if (m_options.prewarm > 0 || m_options.recycle > 0) {
+    // The pool is driven by the main thread's event loop.
+    m_pool.reset(new HostContainerPool(m_classId, m_classContext, m_options));
+  }
+
+  QMutexLocker locker(&g_factoriesMutex);
+  g_factories.append(this);
 }
 
-HostContainerFactory::~HostContainerFactory() {}
+HostContainerFactory::~HostContainerFactory() {
+  {
+    QMutexLocker locker(&g_factoriesMutex);
+    g_factories.removeOne(this);
+  }
+  if (m_apartmentUnderlying && !m_apartments.isEmpty()) {
+    m_apartments.first()->Invoke([&] {
+      m_apartmentUnderlying.Release();
+      return S_OK;
+    });
+  }
+  spdlog::debug(
+      "Class factory {} released: {} standard marshalers created, {} reused "
+      "in total",
+      m_classId.toString().toStdString(), g_marshalCounts.created.load(),
+      g_marshalCounts.reused.load()
+  );
+  spdlog::debug(
+      "Class factory {} released: {} wrappers created for {} containers in "
+      "total",
+      m_classId.toString().toStdString(), HostContainer::GetWrapperCount(),
+      HostContainer::GetContainerCount()
+  );
+}
 
 ULONG STDMETHODCALLTYPE HostContainerFactory::AddRef() { return ++m_ref; }
 
 ULONG STDMETHODCALLTYPE HostContainerFactory::Release() {
   ULONG n = --m_ref;
-  if (n == 0)
+  if (n == 0) {
     delete this;
+  } else if (n == 1 && m_marshals.Size() > 0) {
+    // The identity behind the cached marshalers holds a reference on this
+    // factory, so once every other one is gone it may be the last. Clearing
+    // the cache breaks that cycle and may delete this factory, which is why
+    // only the local count is used afterwards. A factory that is still in
+    // use creates its marshalers again.
+    m_marshals.Clear();
+  }
   return n;
 }
 
@@ -106,8 +233,44 @@ HostContainerFactory::CreateInstance(IUnknown *outer, REFIID riid, void **ppv) {
   *ppv = nullptr;
   if (outer)
     return CLASS_E_NOAGGREGATION;
-  CComPtr<HostContainer> container =
-      new HostContainer(m_classId, m_classContext);
+  FlightRecorder::Record(FlightEvent::ActivationBegin, m_classId.data1);
+  QElapsedTimer timer;
+  timer.start();
+  HRESULT hr = m_apartments.isEmpty() ? CreateInstanceInPlace(riid, ppv)
+                                      : CreateInstanceInApartment(riid, ppv);
+  m_activationLatency.Record(static_cast<quint64>(timer.nsecsElapsed()));
+  ++m_activationCount;
+  if (FAILED(hr)) {
+    ++m_activationFailureCount;
+  }
+  FlightRecorder::Record(
+      FlightEvent::ActivationEnd, m_classId.data1, static_cast<uint32_t>(hr)
+  );
+  return hr;
+}
+
+HRESULT HostContainerFactory::CreateInstanceInPlace(REFIID riid, void **ppv) {
+  CComPtr<HostContainer> container;
+  if (m_pool) {
+    container = m_pool->Take();
+  }
+  if (container) {
+    container->AcquireServerReference();
+  } else {
+    HostLibraryScheduler *scheduler = nullptr;
+    HostLibraryScheduler::Activation activation;
+    if (auto *runtime = HostSurrogateRuntime::instance()) {
+      scheduler = runtime->GetLibraryScheduler();
+      activation = scheduler->BeginActivation(m_classId);
+    }
+    container = new HostContainer(m_classId, m_classContext, m_options);
+    if (scheduler) {
+      scheduler->EndActivation(activation);
+    }
+    if (m_pool) {
+      container->SetPool(m_pool.data());
+    }
+  }
   if (!container)
     return E_OUTOFMEMORY;
   if (!container->IsInitialized())
@@ -115,14 +278,86 @@ HostContainerFactory::CreateInstance(IUnknown *outer, REFIID riid, void **ppv) {
   return container->QueryInterface(riid, ppv);
 }
 
+void HostContainerFactory::StartApartments(int count, DWORD coInit) {
+  for (int i = 0; i < count; ++i) {
+    QSharedPointer<HostApartmentThread> apartment(new HostApartmentThread(
+        QString("Apartment %1 #%2").arg(m_classId.toString()).arg(i), coInit
+    ));
+    if (apartment->Start()) {
+      m_apartments.append(apartment);
+    }
+  }
+}
+
+QSharedPointer<HostApartmentThread> HostContainerFactory::SelectApartment() {
+  if (m_apartments.size() == 1)
+    return m_apartments.first();
+
+  // There is no affinity to the client: CoCreateInstance reaches the
+  // factory through the service control manager, so the caller seen here
+  // is RPCSS rather than the process that asked for the instance.
+  int index = 0;
+  if (m_options.placement == ShardPlacement::RoundRobin) {
+    index = m_nextApartment;
+    m_nextApartment = (m_nextApartment + 1) % m_apartments.size();
+  } else {
+    // Outstanding calls go straight to the shard and cannot be seen from
+    // here, so the number of live instances stands in for the load.
+    for (int i = 1; i < m_apartments.size(); ++i) {
+      if (m_apartments[i]->GetInstanceCount() <
+          m_apartments[index]->GetInstanceCount()) {
+        index = i;
+      }
+    }
+  }
+
+  return m_apartments[index];
+}
+
+HRESULT
+HostContainerFactory::CreateInstanceInApartment(REFIID riid, void **ppv) {
+  QSharedPointer<HostApartmentThread> apartment = SelectApartment();
+  // The work runs on the thread itself, so it only holds a weak reference.
+  QWeakPointer<HostApartmentThread> weakApartment = apartment;
+  IID iid = riid;
+  QUuid classId = m_classId;
+  DWORD classContext = m_classContext;
+  ClassOptions options = m_options;
+  CComPtr<IClassFactory> underlying = m_apartmentUnderlying;
+  QSharedPointer<CComPtr<IStream>> stream =
+      QSharedPointer<CComPtr<IStream>>::create();
+  if (options.apartment == ClassApartment::Free) {
+    RETURN_IF_FAILED(apartment->Invoke([=] {
+      CComPtr<IUnknown> object;
+      RETURN_IF_FAILED(HostDirectObject::Create(
+          classId, underlying, IID_IUnknown, (void **)&object
+      ));
+      return CoMarshalInterThreadInterfaceInStream(iid, object, &stream->p);
+    }));
+    return CoGetInterfaceAndReleaseStream(stream->Detach(), riid, ppv);
+  }
+  RETURN_IF_FAILED(apartment->Invoke([=] {
+    CComPtr<HostContainer> container =
+        new HostContainer(classId, classContext, options);
+    if (!container)
+      return E_OUTOFMEMORY;
+    container->SetApartment(weakApartment);
+    if (!container->IsInitialized())
+      return CLASS_E_CLASSNOTAVAILABLE;
+    return CoMarshalInterThreadInterfaceInStream(
+        iid, static_cast<IProvideClassInfo2 *>(container.p), &stream->p
+    );
+  }));
+  return CoGetInterfaceAndReleaseStream(stream->Detach(), riid, ppv);
+}
+
 HRESULT STDMETHODCALLTYPE HostContainerFactory::GetUnmarshalClass(
     REFIID riid, void *pv, DWORD dwDestContext, void *pvDestContext,
     DWORD mshlflags, CLSID *pCid
 ) {
   CComPtr<IMarshal> marshal;
-  RETURN_IF_FAILED(CoGetStandardMarshal(
-      riid, GetInterfaceToBeMarshaled(riid), dwDestContext, pvDestContext,
-      mshlflags, &marshal
+  RETURN_IF_FAILED(GetStandardMarshal(
+      riid, dwDestContext, pvDestContext, mshlflags, &marshal
   ));
   return marshal->GetUnmarshalClass(
       riid, pv, dwDestContext, pvDestContext, mshlflags, pCid
@@ -134,9 +369,8 @@ HRESULT STDMETHODCALLTYPE HostContainerFactory::GetMarshalSizeMax(
     DWORD mshlflags, DWORD *pSize
 ) {
   CComPtr<IMarshal> marshal;
-  RETURN_IF_FAILED(CoGetStandardMarshal(
-      riid, GetInterfaceToBeMarshaled(riid), dwDestContext, pvDestContext,
-      mshlflags, &marshal
+  RETURN_IF_FAILED(GetStandardMarshal(
+      riid, dwDestContext, pvDestContext, mshlflags, &marshal
   ));
   return marshal->GetMarshalSizeMax(
       riid, pv, dwDestContext, pvDestContext, mshlflags, pSize
@@ -148,9 +382,8 @@ HRESULT STDMETHODCALLTYPE HostContainerFactory::MarshalInterface(
     void *pvDestContext, DWORD mshlflags
 ) {
   CComPtr<IMarshal> marshal;
-  RETURN_IF_FAILED(CoGetStandardMarshal(
-      riid, GetInterfaceToBeMarshaled(riid), dwDestContext, pvDestContext,
-      mshlflags, &marshal
+  RETURN_IF_FAILED(GetStandardMarshal(
+      riid, dwDestContext, pvDestContext, mshlflags, &marshal
   ));
   return marshal->MarshalInterface(
       pStm, riid, pv, dwDestContext, pvDestContext, mshlflags
@@ -161,9 +394,8 @@ HRESULT STDMETHODCALLTYPE HostContainerFactory::UnmarshalInterface(
     IStream *pStm, REFIID riid, void **ppv
 ) {
   CComPtr<IMarshal> marshal;
-  RETURN_IF_FAILED(CoGetStandardMarshal(
-      riid, GetInterfaceToBeMarshaled(riid), MSHCTX_LOCAL, nullptr,
-      MSHLFLAGS_NORMAL, &marshal
+  RETURN_IF_FAILED(GetStandardMarshal(
+      riid, MSHCTX_LOCAL, nullptr, MSHLFLAGS_NORMAL, &marshal
   ));
   return marshal->UnmarshalInterface(pStm, riid, ppv);
 }
@@ -171,9 +403,8 @@ HRESULT STDMETHODCALLTYPE HostContainerFactory::UnmarshalInterface(
 HRESULT STDMETHODCALLTYPE
 HostContainerFactory::ReleaseMarshalData(IStream *pStm) {
   CComPtr<IMarshal> marshal;
-  RETURN_IF_FAILED(CoGetStandardMarshal(
-      IID_IUnknown, GetInterfaceToBeMarshaled(IID_IUnknown), MSHCTX_LOCAL,
-      nullptr, MSHLFLAGS_NORMAL, &marshal
+  RETURN_IF_FAILED(GetStandardMarshal(
+      IID_IUnknown, MSHCTX_LOCAL, nullptr, MSHLFLAGS_NORMAL, &marshal
   ));
   return marshal->ReleaseMarshalData(pStm);
 }
@@ -181,9 +412,32 @@ HostContainerFactory::ReleaseMarshalData(IStream *pStm) {
 HRESULT STDMETHODCALLTYPE
 HostContainerFactory::DisconnectObject(DWORD dwReserved) {
   CComPtr<IMarshal> marshal;
-  RETURN_IF_FAILED(CoGetStandardMarshal(
-      IID_IUnknown, GetInterfaceToBeMarshaled(IID_IUnknown), MSHCTX_LOCAL,
-      nullptr, MSHLFLAGS_NORMAL, &marshal
+  RETURN_IF_FAILED(GetStandardMarshal(
+      IID_IUnknown, MSHCTX_LOCAL, nullptr, MSHLFLAGS_NORMAL, &marshal
   ));
+  // Marshalers created before the disconnect refer to the torn-down stubs.
+  m_marshals.Clear();
   return marshal->DisconnectObject(dwReserved);
 }
+
+quint64 HostContainerFactory::GetStandardMarshalCreatedCount() {
+  return g_marshalCounts.created;
+}
+
+quint64 HostContainerFactory::GetStandardMarshalReusedCount() {
+  return g_marshalCounts.reused;
+}
+
+QList<HostActivationStats> HostContainerFactory::GetActivationStats() {
+  QMutexLocker locker(&g_factoriesMutex);
+  QList<HostActivationStats> stats;
+  stats.reserve(g_factories.size());
+  for (HostContainerFactory *factory : g_factories) {
+    HostActivationStats &item = stats.emplace_back();
+    item.classId = factory->m_classId;
+    item.activations = factory->m_activationCount;
+    item.failures = factory->m_activationFailureCount;
+    factory->m_activationLatency.Snapshot(item.latency);
+  }
+  return stats;
+}
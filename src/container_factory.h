@@ -20,28 +20,84 @@
 #define CONTAINER_FACTORY_H
 
 #include <atomic>
+#include <tuple>
 
 #include <atlcomcli.h>
 #include <windows.h>
 
+#include <QList>
+#include <QMutex>
+#include <QScopedPointer>
+#include <QSharedPointer>
 #include <QUuid>
 
+#include "apartment_thread.h"
+#include "class_options.h"
+#include "container_pool.h"
+#include "invoke_metrics.h"
+#include "marshaler_cache.h"
+
+// Activations of one class factory, with their latencies in nanoseconds.
+struct HostActivationStats {
+  QUuid classId;
+  quint64 activations = 0;
+  quint64 failures = 0;
+  InvokeHistogram::Counts latency{};
+};
+
 class HostContainerFactory : public IClassFactory, public IMarshal {
 private:
   std::atomic<ULONG> m_ref{0};
 
   QUuid m_classId;
   DWORD m_classContext;
+  ClassOptions m_options;
 
   CComPtr<IClassFactory> m_underlying;
+  // The class object of free-threaded classes, loaded in their apartment.
+  CComPtr<IClassFactory> m_apartmentUnderlying;
+
+  QScopedPointer<HostContainerPool> m_pool;
+  QList<QSharedPointer<HostApartmentThread>> m_apartments;
+  int m_nextApartment = 0;
 
   IUnknown *m_unk;
   IUnknown *m_underlyingUnk;
 
+  struct MarshalKey {
+    IID riid;
+    DWORD destContext;
+    DWORD mshlflags;
+
+    bool operator<(const MarshalKey &other) const;
+  };
+
+  static MarshalerCacheCounts g_marshalCounts;
+
+  MarshalerCache<MarshalKey, CComPtr<IMarshal>> m_marshals{&g_marshalCounts};
+
+  std::atomic<quint64> m_activationCount{0};
+  std::atomic<quint64> m_activationFailureCount{0};
+  InvokeHistogram m_activationLatency;
+
+  static QMutex g_factoriesMutex;
+  static QList<HostContainerFactory *> g_factories;
+
   IUnknown *GetInterfaceToBeMarshaled(REFIID riid);
+  void StartApartments(int count, DWORD coInit = COINIT_APARTMENTTHREADED);
+  QSharedPointer<HostApartmentThread> SelectApartment();
+  HRESULT CreateInstanceInPlace(REFIID riid, void **ppv);
+  HRESULT CreateInstanceInApartment(REFIID riid, void **ppv);
+  HRESULT GetStandardMarshal(
+      REFIID riid, DWORD dwDestContext, void *pvDestContext, DWORD mshlflags,
+      IMarshal **ppMarshal
+  );
 
 public:
-  HostContainerFactory(REFCLSID clsid, DWORD clsctx = CLSCTX_SERVER);
+  HostContainerFactory(
+      REFCLSID clsid, DWORD clsctx = CLSCTX_SERVER,
+      const ClassOptions &options = ClassOptions()
+  );
   ~HostContainerFactory();
 
   ULONG STDMETHODCALLTYPE AddRef() override;
@@ -69,6 +125,11 @@ public:
   UnmarshalInterface(IStream *pStm, REFIID riid, void **ppv) override;
   HRESULT STDMETHODCALLTYPE ReleaseMarshalData(IStream *pStm) override;
   HRESULT STDMETHODCALLTYPE DisconnectObject(DWORD dwReserved) override;
+
+public:
+  static quint64 GetStandardMarshalCreatedCount();
+  static quint64 GetStandardMarshalReusedCount();
+  static QList<HostActivationStats> GetActivationStats();
 };
 
 #endif // CONTAINER_FACTORY_H
@@ -0,0 +1,174 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "container_pool.h"
+
+#include <algorithm>
+
+#include <QAbstractEventDispatcher>
+#include <QCoreApplication>
+
+#include "spdlog/spdlog.h"
+
+std::atomic<quint64> HostContainerPool::g_hitCount{0};
+std::atomic<quint64> HostContainerPool::g_missCount{0};
+std::atomic<quint64> HostContainerPool::g_recycledCount{0};
+
+HostContainerPool::HostContainerPool(
+    REFCLSID clsid, DWORD clsctx, const ClassOptions &options, QObject *parent
+)
+    : QObject(parent),
+      m_classId(clsid),
+      m_classContext(clsctx),
+      m_options(options) {
+  m_expiryTimer.setSingleShot(true);
+  connect(
+      &m_expiryTimer, &QTimer::timeout, this, &HostContainerPool::PurgeExpired
+  );
+  QCoreApplication *app = QCoreApplication::instance();
+  if (!app) {
+    return;
+  }
+  QAbstractEventDispatcher *dispatcher = app->eventDispatcher();
+  if (!dispatcher) {
+    return;
+  }
+  connect(
+      dispatcher, &QAbstractEventDispatcher::aboutToBlock, this,
+      &HostContainerPool::OnAboutToBlock
+  );
+}
+
+HostContainerPool::~HostContainerPool() {
+  spdlog::debug(
+      "Container pool {}: {} hits, {} misses, {} recycled, {} unused",
+      m_classId.toString().toStdString(), m_hitCount, m_missCount,
+      m_recycledCount, m_entries.size()
+  );
+  for (Entry &entry : m_entries) {
+    Discard(entry);
+  }
+  m_entries.clear();
+}
+
+void HostContainerPool::Discard(Entry &entry) {
+  // Detach first, so that the final release destroys the container instead
+  // of handing it back to this pool.
+  entry.container->SetPool(nullptr);
+  entry.container.Release();
+}
+
+CComPtr<HostContainer> HostContainerPool::Take() {
+  PurgeExpired();
+  if (m_entries.isEmpty()) {
+    ++m_missCount;
+    ++g_missCount;
+    return nullptr;
+  }
+  ++m_hitCount;
+  ++g_hitCount;
+  // Prefer the most recently used control; older ones are left to expire.
+  return m_entries.takeLast().container;
+}
+
+bool HostContainerPool::Recycle(HostContainer *container) {
+  if (m_options.recycle <= 0)
+    return false;
+  if (m_entries.size() >= std::max(m_options.prewarm, kMaxRecycledContainers))
+    return false;
+  if (container->GetReuseCount() >= m_options.recycle)
+    return false;
+  if (container->HasConnections())
+    return false;
+  if (FAILED(container->Reset()))
+    return false;
+  container->ReleaseServerReference();
+  Entry entry{container, {}, true};
+  entry.idle.start();
+  m_entries.append(entry);
+  ++m_recycledCount;
+  ++g_recycledCount;
+  if (!m_expiryTimer.isActive()) {
+    m_expiryTimer.start(m_options.recycleIdleSeconds * 1000);
+  }
+  return true;
+}
+
+quint64 HostContainerPool::GetHitCount() const { return m_hitCount; }
+
+quint64 HostContainerPool::GetMissCount() const { return m_missCount; }
+
+quint64 HostContainerPool::GetRecycledCount() const { return m_recycledCount; }
+
+quint64 HostContainerPool::GetTotalHitCount() { return g_hitCount; }
+
+quint64 HostContainerPool::GetTotalMissCount() { return g_missCount; }
+
+quint64 HostContainerPool::GetTotalRecycledCount() { return g_recycledCount; }
+
+void HostContainerPool::OnAboutToBlock() {
+  if (m_failed || m_refillScheduled || m_entries.size() >= m_options.prewarm)
+    return;
+  // Creating a control pumps messages, so it must not run from inside the
+  // dispatcher's notification.
+  m_refillScheduled = true;
+  QTimer::singleShot(0, this, &HostContainerPool::Refill);
+}
+
+void HostContainerPool::Refill() {
+  m_refillScheduled = false;
+  if (m_failed || m_entries.size() >= m_options.prewarm)
+    return;
+  CComPtr<HostContainer> container =
+      new HostContainer(m_classId, m_classContext, m_options, true);
+  if (!container || !container->IsInitialized()) {
+    // Loading failed and has already been reported; do not retry on every
+    // idle cycle. Activation falls back to creating containers on demand.
+    m_failed = true;
+    return;
+  }
+  container->SetPool(this);
+  Entry entry{container, {}, false};
+  m_entries.prepend(entry);
+}
+
+void HostContainerPool::PurgeExpired() {
+  qint64 maxIdle = qint64(m_options.recycleIdleSeconds) * 1000;
+  qint64 nextExpiry = -1;
+  for (auto it = m_entries.begin(); it != m_entries.end();) {
+    if (!it->recycled) {
+      ++it;
+      continue;
+    }
+    qint64 elapsed = it->idle.elapsed();
+    if (elapsed >= maxIdle) {
+      Discard(*it);
+      it = m_entries.erase(it);
+      continue;
+    }
+    qint64 remaining = maxIdle - elapsed;
+    if (nextExpiry < 0 || remaining < nextExpiry)
+      nextExpiry = remaining;
+    ++it;
+  }
+  if (nextExpiry >= 0) {
+    m_expiryTimer.start(nextExpiry);
+  } else {
+    m_expiryTimer.stop();
+  }
+}
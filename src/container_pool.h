@@ -0,0 +1,102 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef CONTAINER_POOL_H
+#define CONTAINER_POOL_H
+
+#include <atomic>
+
+#include <windows.h>
+
+#include <atlcomcli.h>
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <QTimer>
+#include <QUuid>
+
+#include "class_options.h"
+#include "container.h"
+
+// Keeps fully initialized containers for one class, so that activation only
+// has to hand one of them over. The pool is filled up to 'prewarm' controls,
+// one at a time whenever the event loop is about to go idle. With 'recycle',
+// released containers whose control could be reset are put back as well and
+// are destroyed once they have been idle for too long. Pooled containers do
+// not hold a server reference until they are taken.
+class HostContainerPool : public QObject {
+  Q_OBJECT
+
+private:
+  struct Entry {
+    CComPtr<HostContainer> container;
+    QElapsedTimer idle;
+    bool recycled;
+  };
+
+  static constexpr int kMaxRecycledContainers = 8;
+
+  QUuid m_classId;
+  DWORD m_classContext;
+  ClassOptions m_options;
+
+  QList<Entry> m_entries;
+  QTimer m_expiryTimer;
+
+  bool m_refillScheduled = false;
+  bool m_failed = false;
+
+  quint64 m_hitCount = 0;
+  quint64 m_missCount = 0;
+  quint64 m_recycledCount = 0;
+
+  // Totals of all pools, which the statistics page publishes while pools
+  // come and go with their factories.
+  static std::atomic<quint64> g_hitCount;
+  static std::atomic<quint64> g_missCount;
+  static std::atomic<quint64> g_recycledCount;
+
+private:
+  void Discard(Entry &entry);
+
+public:
+  HostContainerPool(
+      REFCLSID clsid, DWORD clsctx, const ClassOptions &options,
+      QObject *parent = nullptr
+  );
+  ~HostContainerPool();
+
+  CComPtr<HostContainer> Take();
+  bool Recycle(HostContainer *container);
+
+  quint64 GetHitCount() const;
+  quint64 GetMissCount() const;
+  quint64 GetRecycledCount() const;
+
+  static quint64 GetTotalHitCount();
+  static quint64 GetTotalMissCount();
+  static quint64 GetTotalRecycledCount();
+
+private slots:
+  void OnAboutToBlock();
+  void Refill();
+  void PurgeExpired();
+};
+
+#endif // CONTAINER_POOL_H
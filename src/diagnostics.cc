@@ -0,0 +1,135 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "diagnostics.h"
+
+#include <QCoreApplication>
+#include <QMessageBox>
+#include <QMutexLocker>
+#include <QThread>
+
+#include "spdlog/spdlog.h"
+
+QMutex Diagnostics::g_mutex;
+QList<Diagnostic> Diagnostics::g_diagnostics;
+std::atomic<bool> Diagnostics::g_interactive{false};
+std::atomic<quint64> Diagnostics::g_errorCount{0};
+std::atomic<quint64> Diagnostics::g_warningCount{0};
+
+void Diagnostics::SetInteractive(bool interactive) {
+  g_interactive = interactive;
+}
+
+bool Diagnostics::IsInteractive() { return g_interactive; }
+
+void Diagnostics::ShowMessageBox(
+    DiagnosticSeverity severity, const QString &text
+) {
+  QCoreApplication *app = QCoreApplication::instance();
+  if (!app)
+    return;
+  auto show = [severity, text] {
+    QString title = QCoreApplication::applicationName();
+    switch (severity) {
+    case DiagnosticSeverity::Information:
+      QMessageBox::information(nullptr, title, text);
+      break;
+    case DiagnosticSeverity::Warning:
+      QMessageBox::warning(nullptr, title, text);
+      break;
+    case DiagnosticSeverity::Error:
+      QMessageBox::critical(nullptr, title, text);
+      break;
+    }
+  };
+  if (QThread::currentThread() == app->thread()) {
+    show();
+  } else {
+    QMetaObject::invokeMethod(app, show, Qt::QueuedConnection);
+  }
+}
+
+void Diagnostics::Report(DiagnosticSeverity severity, const QString &text) {
+  Diagnostic diagnostic;
+  diagnostic.time = QDateTime::currentDateTime();
+  diagnostic.severity = severity;
+  diagnostic.title = text.section('\n', 0, 0).trimmed();
+  diagnostic.message = text.section('\n', 1).trimmed();
+
+  std::string title = diagnostic.title.toStdString();
+  std::string message =
+      diagnostic.message.simplified().toStdString();
+  switch (severity) {
+  case DiagnosticSeverity::Information:
+    spdlog::info("{} {}", title, message);
+    break;
+  case DiagnosticSeverity::Warning:
+    ++g_warningCount;
+    spdlog::warn("{} {}", title, message);
+    break;
+  case DiagnosticSeverity::Error:
+    ++g_errorCount;
+    spdlog::error("{} {}", title, message);
+    break;
+  }
+
+  {
+    QMutexLocker locker(&g_mutex);
+    if (g_diagnostics.size() >= kMaxDiagnostics) {
+      g_diagnostics.removeFirst();
+    }
+    g_diagnostics.append(diagnostic);
+  }
+
+  if (g_interactive) {
+    ShowMessageBox(severity, text);
+  }
+}
+
+void Diagnostics::Information(const QString &text) {
+  Report(DiagnosticSeverity::Information, text);
+}
+
+void Diagnostics::Warning(const QString &text) {
+  Report(DiagnosticSeverity::Warning, text);
+}
+
+void Diagnostics::Error(const QString &text) {
+  Report(DiagnosticSeverity::Error, text);
+}
+
+QList<Diagnostic> Diagnostics::GetDiagnostics() {
+  QMutexLocker locker(&g_mutex);
+  return g_diagnostics;
+}
+
+quint64 Diagnostics::GetErrorCount() { return g_errorCount; }
+
+quint64 Diagnostics::GetWarningCount() { return g_warningCount; }
+
+void Diagnostics::Clear() {
+  QMutexLocker locker(&g_mutex);
+  g_diagnostics.clear();
+}
+
+void Diagnostics::Reset() {
+  QMutexLocker locker(&g_mutex);
+  g_diagnostics.clear();
+  g_errorCount = 0;
+  g_warningCount = 0;
+}
@@ -0,0 +1,78 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include <atomic>
+
+#include <QDateTime>
+#include <QList>
+#include <QMutex>
+#include <QString>
+
+enum class DiagnosticSeverity {
+  Information,
+  Warning,
+  Error,
+};
+
+struct Diagnostic {
+  QDateTime time;
+  DiagnosticSeverity severity;
+  QString title;
+  QString message;
+};
+
+// Collects problems found while serving COM clients. Every report is logged
+// and kept in a bounded list; a modal dialog is shown only in interactive
+// mode, so that a host without a user never blocks its message loop.
+// Reports use the usual "Severity: Title\n\nMessage" text layout.
+class Diagnostics {
+private:
+  static constexpr int kMaxDiagnostics = 256;
+
+  static QMutex g_mutex;
+  static QList<Diagnostic> g_diagnostics;
+  static std::atomic<bool> g_interactive;
+  static std::atomic<quint64> g_errorCount;
+  static std::atomic<quint64> g_warningCount;
+
+  static void ShowMessageBox(DiagnosticSeverity severity, const QString &text);
+
+public:
+  static void SetInteractive(bool interactive);
+  static bool IsInteractive();
+
+  static void Report(DiagnosticSeverity severity, const QString &text);
+  static void Information(const QString &text);
+  static void Warning(const QString &text);
+  static void Error(const QString &text);
+
+  static QList<Diagnostic> GetDiagnostics();
+  static quint64 GetErrorCount();
+  static quint64 GetWarningCount();
+
+  // Drops the kept reports. The counts still include them.
+  static void Clear();
+  // Drops the kept reports and their counts, for reports that are about to
+  // be made again.
+  static void Reset();
+};
+
+#endif // DIAGNOSTICS_H
@@ -0,0 +1,104 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "direct_object.h"
+
+#include <wil/result.h>
+
+#include "surrogate_runtime.h"
+
+HostDirectObject::HostDirectObject(REFCLSID clsid, IUnknown *object)
+    : m_classId(clsid),
+      m_object(object) {
+  if (auto *runtime = HostSurrogateRuntime::instance()) {
+    runtime->AddServerReference();
+  }
+  CComPtr<IProvideClassInfo> underlyingPCI;
+  CComPtr<IProvideClassInfo2> underlyingPCI2;
+  m_object->QueryInterface(IID_IProvideClassInfo, (void **)&underlyingPCI);
+  m_object->QueryInterface(IID_IProvideClassInfo2, (void **)&underlyingPCI2);
+  m_provideClassInfo =
+      new HostProvideClassInfo(clsid, underlyingPCI, underlyingPCI2);
+}
+
+HostDirectObject::~HostDirectObject() {
+  m_provideClassInfo.Release();
+  m_object.Release();
+  if (auto *runtime = HostSurrogateRuntime::instance()) {
+    runtime->ReleaseServerReference();
+  }
+}
+
+HRESULT HostDirectObject::Create(
+    REFCLSID clsid, IClassFactory *factory, REFIID riid, void **ppv
+) {
+  if (!ppv)
+    return E_POINTER;
+  *ppv = nullptr;
+  if (!factory)
+    return CLASS_E_CLASSNOTAVAILABLE;
+  CComPtr<IUnknown> object;
+  RETURN_IF_FAILED(
+      factory->CreateInstance(nullptr, IID_IUnknown, (void **)&object)
+  );
+  CComPtr<HostDirectObject> direct = new HostDirectObject(clsid, object);
+  if (!direct)
+    return E_OUTOFMEMORY;
+  return direct->QueryInterface(riid, ppv);
+}
+
+ULONG STDMETHODCALLTYPE HostDirectObject::AddRef() { return ++m_ref; }
+
+ULONG STDMETHODCALLTYPE HostDirectObject::Release() {
+  ULONG n = --m_ref;
+  if (n == 0)
+    delete this;
+  return n;
+}
+
+HRESULT STDMETHODCALLTYPE
+HostDirectObject::QueryInterface(REFIID riid, void **ppv) {
+  if (!ppv)
+    return E_POINTER;
+  *ppv = nullptr;
+  if (riid == IID_IUnknown) {
+    *ppv = static_cast<IProvideClassInfo2 *>(this);
+  } else if (riid == IID_IProvideClassInfo2) {
+    *ppv = static_cast<IProvideClassInfo2 *>(this);
+  } else if (riid == IID_IProvideClassInfo) {
+    *ppv = static_cast<IProvideClassInfo *>(this);
+  } else if (riid == IID_IMarshal || riid == IID_IAgileObject) {
+    // An object aggregating the free-threaded marshaler would hand its raw
+    // pointer to the client, bypassing this wrapper and the server
+    // reference it holds.
+    return E_NOINTERFACE;
+  } else {
+    return m_object->QueryInterface(riid, ppv);
+  }
+  AddRef();
+  return S_OK;
+}
+
+HRESULT STDMETHODCALLTYPE HostDirectObject::GetClassInfo(ITypeInfo **ppTI) {
+  return m_provideClassInfo->GetClassInfo(ppTI);
+}
+
+HRESULT STDMETHODCALLTYPE
+HostDirectObject::GetGUID(DWORD dwGuidKind, GUID *pGUID) {
+  return m_provideClassInfo->GetGUID(dwGuidKind, pGUID);
+}
@@ -0,0 +1,61 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef DIRECT_OBJECT_H
+#define DIRECT_OBJECT_H
+
+#include <atomic>
+
+#include <windows.h>
+
+#include <atlcomcli.h>
+#include <ocidl.h>
+
+#include <QUuid>
+
+#include "provide_class_info.h"
+
+// Free-threaded object created straight from its class factory, without a
+// QAxWidget around it. Only the class info is supplied by the host; every
+// other interface, connection points included, belongs to the object.
+class HostDirectObject : public IProvideClassInfo2 {
+private:
+  std::atomic<ULONG> m_ref{0};
+
+  QUuid m_classId;
+
+  CComPtr<IUnknown> m_object;
+  CComPtr<HostProvideClassInfo> m_provideClassInfo;
+
+public:
+  HostDirectObject(REFCLSID clsid, IUnknown *object);
+  ~HostDirectObject();
+
+  static HRESULT
+  Create(REFCLSID clsid, IClassFactory *factory, REFIID riid, void **ppv);
+
+  ULONG STDMETHODCALLTYPE AddRef() override;
+  ULONG STDMETHODCALLTYPE Release() override;
+
+  HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void **ppv) override;
+
+  HRESULT STDMETHODCALLTYPE GetClassInfo(ITypeInfo **ppTI) override;
+  HRESULT STDMETHODCALLTYPE GetGUID(DWORD dwGuidKind, GUID *pGUID) override;
+};
+
+#endif // DIRECT_OBJECT_H
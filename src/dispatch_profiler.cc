@@ -0,0 +1,70 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "dispatch_profiler.h"
+
+#include <QElapsedTimer>
+
+HostDispatchProfiler::HostDispatchProfiler(
+    REFCLSID clsid, IDispatch *underlying
+)
+    : m_classId(clsid),
+      m_underlying(underlying) {}
+
+InvokeHistogram *HostDispatchProfiler::GetHistogram(DISPID dispIdMember) {
+  auto it = m_histograms.find(dispIdMember);
+  if (it != m_histograms.end())
+    return it->second;
+  InvokeHistogram *histogram =
+      InvokeMetrics::GetHistogram(m_classId, dispIdMember, m_underlying);
+  m_histograms.emplace(dispIdMember, histogram);
+  return histogram;
+}
+
+HRESULT STDMETHODCALLTYPE
+HostDispatchProfiler::GetTypeInfoCount(UINT *pctinfo) {
+  return m_underlying->GetTypeInfoCount(pctinfo);
+}
+
+HRESULT STDMETHODCALLTYPE HostDispatchProfiler::GetTypeInfo(
+    UINT iTInfo, LCID lcid, ITypeInfo **ppTInfo
+) {
+  return m_underlying->GetTypeInfo(iTInfo, lcid, ppTInfo);
+}
+
+HRESULT STDMETHODCALLTYPE HostDispatchProfiler::GetIDsOfNames(
+    REFIID riid, LPOLESTR *rgszNames, UINT cNames, LCID lcid, DISPID *rgDispId
+) {
+  return m_underlying->GetIDsOfNames(riid, rgszNames, cNames, lcid, rgDispId);
+}
+
+HRESULT STDMETHODCALLTYPE HostDispatchProfiler::Invoke(
+    DISPID dispIdMember, REFIID riid, LCID lcid, WORD wFlags,
+    DISPPARAMS *pDispParams, VARIANT *pVarResult, EXCEPINFO *pExcepInfo,
+    UINT *puArgErr
+) {
+  InvokeHistogram *histogram = GetHistogram(dispIdMember);
+  QElapsedTimer timer;
+  timer.start();
+  HRESULT hr = m_underlying->Invoke(
+      dispIdMember, riid, lcid, wFlags, pDispParams, pVarResult, pExcepInfo,
+      puArgErr
+  );
+  histogram->Record(static_cast<quint64>(timer.nsecsElapsed()));
+  return hr;
+}
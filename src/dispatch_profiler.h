@@ -0,0 +1,62 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef DISPATCH_PROFILER_H
+#define DISPATCH_PROFILER_H
+
+#include <unordered_map>
+
+#include <atlcomcli.h>
+#include <oaidl.h>
+#include <windows.h>
+
+#include <QUuid>
+
+#include "invoke_metrics.h"
+#include "unknown_impl.h"
+
+// Times every Invoke on the control's IDispatch and records it per DISPID.
+// It lives in the control's apartment, so the histogram lookups cached
+// here need no locking.
+class HostDispatchProfiler : public CUnknownImpl<IDispatch> {
+private:
+  QUuid m_classId;
+  CComPtr<IDispatch> m_underlying;
+  std::unordered_map<DISPID, InvokeHistogram *> m_histograms;
+
+  InvokeHistogram *GetHistogram(DISPID dispIdMember);
+
+public:
+  HostDispatchProfiler(REFCLSID clsid, IDispatch *underlying);
+
+public:
+  HRESULT STDMETHODCALLTYPE GetTypeInfoCount(UINT *pctinfo) override;
+  HRESULT STDMETHODCALLTYPE
+  GetTypeInfo(UINT iTInfo, LCID lcid, ITypeInfo **ppTInfo) override;
+  HRESULT STDMETHODCALLTYPE GetIDsOfNames(
+      REFIID riid, LPOLESTR *rgszNames, UINT cNames, LCID lcid,
+      DISPID *rgDispId
+  ) override;
+  HRESULT STDMETHODCALLTYPE Invoke(
+      DISPID dispIdMember, REFIID riid, LCID lcid, WORD wFlags,
+      DISPPARAMS *pDispParams, VARIANT *pVarResult, EXCEPINFO *pExcepInfo,
+      UINT *puArgErr
+  ) override;
+};
+
+#endif // DISPATCH_PROFILER_H
@@ -0,0 +1,186 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "event_call.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+
+static constexpr std::size_t kMaxPooledEventCalls = 256;
+
+static QMutex g_poolMutex;
+static std::vector<HostEventCall *> g_pool;
+
+HostEventCall::~HostEventCall() { ClearParams(); }
+
+void HostEventCall::Reset() {
+  ClearParams();
+  dispIdMember = DISPID_UNKNOWN;
+  riid = IID_NULL;
+  lcid = 0;
+  wFlags = 0;
+  pDispParams = nullptr;
+  pVarResult = nullptr;
+  pExcepInfo = nullptr;
+  puArgErr = nullptr;
+  cookie = 0;
+  serial = 0;
+  coalesced = false;
+  result = S_OK;
+  completed = nullptr;
+  m_ownedCompleted.reset();
+  m_state = Queued;
+}
+
+void HostEventCall::ClearParams() {
+  for (VARIANTARG &arg : m_args) {
+    VariantClear(&arg);
+  }
+  m_args.clear();
+  m_namedArgs.clear();
+  m_params = {};
+}
+
+void HostEventCall::Recycle(HostEventCall *call) {
+  call->Reset();
+  {
+    QMutexLocker locker(&g_poolMutex);
+    if (g_pool.size() < kMaxPooledEventCalls) {
+      g_pool.push_back(call);
+      return;
+    }
+  }
+  delete call;
+}
+
+ULONG HostEventCall::AddRef() { return ++m_ref; }
+
+ULONG HostEventCall::Release() {
+  ULONG n = --m_ref;
+  if (n == 0)
+    Recycle(this);
+  return n;
+}
+
+HRESULT HostEventCall::CopyParams(const DISPPARAMS *params) {
+  ClearParams();
+  if (params) {
+    m_args.resize(params->cArgs);
+    for (VARIANTARG &arg : m_args) {
+      VariantInit(&arg);
+    }
+    for (UINT i = 0; i < params->cArgs; ++i) {
+      HRESULT hr = VariantCopy(&m_args[i], &params->rgvarg[i]);
+      if (FAILED(hr)) {
+        ClearParams();
+        return hr;
+      }
+    }
+    if (params->rgdispidNamedArgs) {
+      m_namedArgs.assign(
+          params->rgdispidNamedArgs,
+          params->rgdispidNamedArgs + params->cNamedArgs
+      );
+    }
+  }
+  UpdateParams();
+  return S_OK;
+}
+
+void HostEventCall::SwapParams(HostEventCall *other) {
+  m_args.swap(other->m_args);
+  m_namedArgs.swap(other->m_namedArgs);
+  UpdateParams();
+  other->UpdateParams();
+}
+
+void HostEventCall::UpdateParams() {
+  m_params.rgvarg = m_args.empty() ? nullptr : m_args.data();
+  m_params.rgdispidNamedArgs =
+      m_namedArgs.empty() ? nullptr : m_namedArgs.data();
+  m_params.cArgs = static_cast<UINT>(m_args.size());
+  m_params.cNamedArgs = static_cast<UINT>(m_namedArgs.size());
+  pDispParams = &m_params;
+}
+
+void HostEventCall::AbandonCompleted() { m_ownedCompleted.reset(completed); }
+
+bool HostEventCall::IsSynchronous() const { return completed != nullptr; }
+
+bool HostEventCall::BeginDelivery() {
+  State expected = Queued;
+  while (!m_state.compare_exchange_weak(expected, Running)) {
+    if (expected == Dropped || expected == Running)
+      return false;
+    // The producer is replacing the arguments of a coalesced event.
+    expected = Queued;
+    SwitchToThread();
+  }
+  return true;
+}
+
+bool HostEventCall::TakeOver(HostEventCall *newer) {
+  State expected = Queued;
+  if (!m_state.compare_exchange_strong(expected, Updating))
+    return false;
+  lcid = newer->lcid;
+  wFlags = newer->wFlags;
+  SwapParams(newer);
+  m_state = Queued;
+  return true;
+}
+
+void HostEventCall::MarkDropped() {
+  State expected = Queued;
+  m_state.compare_exchange_strong(expected, Dropped);
+}
+
+HostEventCall *HostEventCall::Create() {
+  {
+    QMutexLocker locker(&g_poolMutex);
+    if (!g_pool.empty()) {
+      HostEventCall *call = g_pool.back();
+      g_pool.pop_back();
+      return call;
+    }
+  }
+  return new HostEventCall();
+}
+
+bool HostEventCall::CanCopyParams(const DISPPARAMS *params) {
+  if (!params)
+    return true;
+  if (params->cArgs > 0 && !params->rgvarg)
+    return false;
+  for (UINT i = 0; i < params->cArgs; ++i) {
+    VARTYPE vt = params->rgvarg[i].vt;
+    if (vt & VT_BYREF)
+      return false;
+    // Interface pointers belong to the control's apartment and must not be
+    // used once the control's call has returned. A record holds its
+    // IRecordInfo, and arrays of records hold it as well.
+    switch (vt & VT_TYPEMASK) {
+    case VT_DISPATCH:
+    case VT_UNKNOWN:
+    case VT_VARIANT:
+    case VT_RECORD:
+      return false;
+    }
+  }
+  return true;
+}
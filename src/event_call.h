@@ -0,0 +1,99 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef EVENT_CALL_H
+#define EVENT_CALL_H
+
+#include <atomic>
+#include <vector>
+
+#include <wil/resource.h>
+#include <windows.h>
+
+#include <QtGlobal>
+
+// A single event delivery handed from the control's thread to a worker.
+// Instances are recycled through a process-wide pool, so the argument
+// buffers of asynchronous calls keep their capacity between events.
+class HostEventCall {
+public:
+  enum State {
+    Queued,
+    Updating,
+    Running,
+    Dropped,
+  };
+
+private:
+  std::atomic<ULONG> m_ref{0};
+  std::atomic<State> m_state{Queued};
+
+  wil::unique_event m_ownedCompleted;
+
+  std::vector<VARIANTARG> m_args;
+  std::vector<DISPID> m_namedArgs;
+  DISPPARAMS m_params{};
+
+protected:
+  HostEventCall() = default;
+  ~HostEventCall();
+
+private:
+  void Reset();
+  void ClearParams();
+  void UpdateParams();
+  void SwapParams(HostEventCall *other);
+
+  static void Recycle(HostEventCall *call);
+
+public:
+  DISPID dispIdMember = DISPID_UNKNOWN;
+  IID riid = IID_NULL;
+  LCID lcid = 0;
+  WORD wFlags = 0;
+  DISPPARAMS *pDispParams = nullptr;
+  VARIANT *pVarResult = nullptr;
+  EXCEPINFO *pExcepInfo = nullptr;
+  UINT *puArgErr = nullptr;
+
+  DWORD cookie = 0;
+  quint64 serial = 0;
+  bool coalesced = false;
+
+  HRESULT result = S_OK;
+  HANDLE completed = nullptr;
+
+public:
+  ULONG AddRef();
+  ULONG Release();
+
+  HRESULT CopyParams(const DISPPARAMS *params);
+
+  void AbandonCompleted();
+
+  bool IsSynchronous() const;
+  bool BeginDelivery();
+  bool TakeOver(HostEventCall *newer);
+  void MarkDropped();
+
+public:
+  static HostEventCall *Create();
+  static bool CanCopyParams(const DISPPARAMS *params);
+};
+
+#endif // EVENT_CALL_H
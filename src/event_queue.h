@@ -0,0 +1,333 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "bounded_queue.h"
+#include "event_signal.h"
+
+enum class EventOverflow {
+  Block,
+  DropOldest,
+  DropNewest,
+};
+
+enum class EventPostResult {
+  Queued,
+  Coalesced,
+  Dropped,
+  Stopped,
+  WaitFailed,
+};
+
+// What an event queue leaves to its owner: delivering the calls it takes
+// out, and running its drain tasks when it has no thread of its own.
+template <typename Call> class EventDispatcher {
+public:
+  virtual ~EventDispatcher() = default;
+
+  // The queue keeps its reference to the call until this returns.
+  virtual void Deliver(Call *call) = 0;
+  virtual void Schedule(std::function<void()> task) = 0;
+};
+
+// Delivers the events of a single sink in FIFO order. The control's thread is
+// the only producer. The consumer is either a long-lived thread owned by the
+// queue, or drain tasks run by the dispatcher that never run concurrently.
+//
+// Calls are reference counted with AddRef and Release. A call whose caller
+// waits for it is IsSynchronous and never evicted. Coalesced calls are keyed
+// by their dispIdMember, and TakeOver moves the arguments of a newer call
+// into the queued one unless its delivery has already begun.
+template <typename Call> class EventQueue {
+public:
+  using Key = decltype(Call::dispIdMember);
+
+private:
+  BoundedQueue<Call *> m_queue;
+  EventOverflow m_overflow;
+  EventDispatcher<Call> *m_dispatcher;
+  bool m_pooled;
+  std::thread m_thread;
+
+  EventSignal m_wakeup;
+  EventSignal m_finished{true};
+  EventSignal m_spaceAvailable{true};
+  std::atomic<bool> m_waiting{false};
+  // Waits for space nest when the producer dispatches incoming calls that
+  // post events themselves, so every waiting frame is counted.
+  std::atomic<int> m_producersWaiting{0};
+  std::atomic<bool> m_draining{false};
+  std::atomic<bool> m_stopping{false};
+  // Queued calls whose caller waits for them, which are never evicted.
+  std::atomic<int> m_synchronousCount{0};
+
+  std::atomic<uint64_t> m_posted{0};
+  std::atomic<uint64_t> m_dropped{0};
+
+  // The newest queued call of every coalesced key. Calls leave it before
+  // the queue releases them, when they are delivered or dropped.
+  std::mutex m_coalescedMutex;
+  std::unordered_map<Key, Call *> m_coalesced;
+
+  // Calls in the queues of all workers, for the statistics page.
+  static inline std::atomic<int64_t> g_queuedCount{0};
+
+private:
+  void Run() {
+    while (true) {
+      Call *call = nullptr;
+      if (m_queue.TryPop(call)) {
+        Dispatch(call);
+        continue;
+      }
+      if (m_stopping)
+        break;
+      m_waiting = true;
+      if (!m_queue.IsEmpty() || m_stopping) {
+        m_waiting = false;
+        continue;
+      }
+      m_wakeup.Wait();
+    }
+  }
+
+  void Drain() {
+    while (true) {
+      Call *call = nullptr;
+      while (m_queue.TryPop(call)) {
+        Dispatch(call);
+      }
+      m_draining = false;
+      if (m_queue.IsEmpty() || m_draining.exchange(true))
+        return;
+    }
+  }
+
+  void Dispatch(Call *call) {
+    --g_queuedCount;
+    if (call->IsSynchronous()) {
+      --m_synchronousCount;
+    }
+    ForgetCoalesced(call);
+    if (m_producersWaiting > 0) {
+      m_spaceAvailable.Set();
+    }
+    m_dispatcher->Deliver(call);
+    call->Release();
+  }
+
+  void Notify() {
+    if (m_pooled) {
+      if (!m_draining.exchange(true)) {
+        m_dispatcher->Schedule([this]() { Drain(); });
+      }
+    } else if (m_waiting.exchange(false)) {
+      m_wakeup.Set();
+    }
+  }
+
+  bool WaitForSpace() {
+    // The event stays set until a wait starts again, so an outer wait also
+    // wakes up once a nested one has been satisfied.
+    ++m_producersWaiting;
+    if (!m_stopping) {
+      m_spaceAvailable.Reset();
+    }
+    bool ready = m_queue.Size() < m_queue.Capacity() || m_stopping ||
+                 m_spaceAvailable.Wait(true);
+    --m_producersWaiting;
+    return ready;
+  }
+
+  void Queued() {
+    ++m_posted;
+    ++g_queuedCount;
+    Notify();
+  }
+
+  EventPostResult PushOrDrop(Call *call) {
+    call->AddRef();
+    if (!m_queue.TryPush(call)) {
+      Drop(call);
+      return EventPostResult::Dropped;
+    }
+    Queued();
+    return EventPostResult::Queued;
+  }
+
+  void Drop(Call *call) {
+    call->MarkDropped();
+    ForgetCoalesced(call);
+    call->Release();
+    ++m_dropped;
+  }
+
+  void ForgetCoalesced(Call *call) {
+    if (!call->coalesced)
+      return;
+    std::lock_guard<std::mutex> lock(m_coalescedMutex);
+    auto search = m_coalesced.find(call->dispIdMember);
+    if (search != m_coalesced.end() && search->second == call) {
+      m_coalesced.erase(search);
+    }
+  }
+
+public:
+  // Without pooled, the calls are delivered by a thread of the queue's own,
+  // which Start creates.
+  EventQueue(
+      std::size_t capacity, EventOverflow overflow,
+      EventDispatcher<Call> *dispatcher, bool pooled
+  )
+      : m_queue(capacity),
+        m_overflow(overflow),
+        m_dispatcher(dispatcher),
+        m_pooled(pooled) {}
+
+  ~EventQueue() {
+    Stop();
+    Call *call = nullptr;
+    while (m_queue.TryPop(call)) {
+      --g_queuedCount;
+      ForgetCoalesced(call);
+      call->Release();
+    }
+  }
+
+  EventQueue(const EventQueue &) = delete;
+  EventQueue &operator=(const EventQueue &) = delete;
+
+  void Start() {
+    if (m_pooled || m_thread.joinable())
+      return;
+    m_thread = std::thread([this]() {
+      Run();
+      m_finished.Set();
+    });
+  }
+
+  // Waits for the thread to deliver the queued calls. Drain tasks that are
+  // still scheduled keep running until the queue is empty.
+  void Stop() {
+    m_stopping = true;
+    m_wakeup.Set();
+    m_spaceAvailable.Set();
+    if (!m_thread.joinable())
+      return;
+    // The handlers of the queued events may call back into this thread, so
+    // incoming calls are dispatched while waiting.
+    m_finished.Wait(true);
+    m_thread.join();
+  }
+
+  // Waits for space while the queue is full, whatever the overflow policy.
+  EventPostResult Post(Call *call) {
+    call->AddRef();
+    // Counted before the call can be seen in the queue.
+    bool synchronous = call->IsSynchronous();
+    if (synchronous) {
+      ++m_synchronousCount;
+    }
+    while (!m_queue.TryPush(call)) {
+      EventPostResult result = EventPostResult::Stopped;
+      if (!m_stopping) {
+        result = WaitForSpace() ? EventPostResult::Queued
+                                : EventPostResult::WaitFailed;
+      }
+      if (result != EventPostResult::Queued) {
+        if (synchronous) {
+          --m_synchronousCount;
+        }
+        call->Release();
+        return result;
+      }
+    }
+    Queued();
+    return EventPostResult::Queued;
+  }
+
+  EventPostResult PostAsync(Call *call) {
+    if (m_stopping)
+      return EventPostResult::Stopped;
+    switch (m_overflow) {
+    case EventOverflow::Block:
+      return Post(call);
+    case EventOverflow::DropNewest:
+      return PushOrDrop(call);
+    case EventOverflow::DropOldest: {
+      // The oldest call may be one whose caller is still waiting for it.
+      // While there is any, the new event is dropped instead.
+      if (m_synchronousCount > 0)
+        return PushOrDrop(call);
+      Call *evicted = nullptr;
+      call->AddRef();
+      if (m_queue.PushEvicting(call, evicted)) {
+        Drop(evicted);
+        --g_queuedCount;
+      }
+      break;
+    }
+    }
+    Queued();
+    return EventPostResult::Queued;
+  }
+
+  EventPostResult PostCoalesced(Call *call) {
+    Key key = call->dispIdMember;
+    {
+      // While the previous call with the same key has not been picked up
+      // yet, it takes over the new arguments instead of queueing another
+      // one. The replaced arguments are released with call.
+      std::lock_guard<std::mutex> lock(m_coalescedMutex);
+      auto search = m_coalesced.find(key);
+      if (search != m_coalesced.end() && search->second->TakeOver(call))
+        return EventPostResult::Coalesced;
+      // Registered before it is queued, so the consumer always finds it. The
+      // lock is not held while posting, which may wait for space.
+      call->coalesced = true;
+      m_coalesced[key] = call;
+    }
+    EventPostResult result = PostAsync(call);
+    if (result == EventPostResult::Stopped ||
+        result == EventPostResult::WaitFailed) {
+      ForgetCoalesced(call);
+    }
+    return result;
+  }
+
+  uint64_t GetPostedCount() const { return m_posted; }
+
+  uint64_t GetDroppedCount() const { return m_dropped; }
+
+  static uint64_t GetQueuedCount() {
+    return static_cast<uint64_t>(std::max<int64_t>(g_queuedCount, 0));
+  }
+};
+
+#endif // EVENT_QUEUE_H
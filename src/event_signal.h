@@ -0,0 +1,113 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef EVENT_SIGNAL_H
+#define EVENT_SIGNAL_H
+
+#ifdef _WIN32
+#include <windows.h>
+
+#include <objbase.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+// Event that threads wait on until it is set. An auto-reset event is reset
+// again by the wait it releases. On Windows a wait can keep dispatching
+// incoming COM calls, so waits of the same thread may nest.
+class EventSignal {
+private:
+#ifdef _WIN32
+  HANDLE m_handle;
+#else
+  bool m_manualReset;
+  bool m_set = false;
+  std::mutex m_mutex;
+  std::condition_variable m_changed;
+#endif
+
+public:
+  explicit EventSignal(bool manualReset = false)
+#ifdef _WIN32
+      : m_handle(CreateEventW(nullptr, manualReset, FALSE, nullptr)) {
+  }
+#else
+      : m_manualReset(manualReset) {
+  }
+#endif
+
+  ~EventSignal() {
+#ifdef _WIN32
+    if (m_handle) {
+      CloseHandle(m_handle);
+    }
+#endif
+  }
+
+  EventSignal(const EventSignal &) = delete;
+  EventSignal &operator=(const EventSignal &) = delete;
+
+  void Set() {
+#ifdef _WIN32
+    SetEvent(m_handle);
+#else
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_set = true;
+    }
+    if (m_manualReset) {
+      m_changed.notify_all();
+    } else {
+      m_changed.notify_one();
+    }
+#endif
+  }
+
+  void Reset() {
+#ifdef _WIN32
+    ResetEvent(m_handle);
+#else
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_set = false;
+#endif
+  }
+
+  // With dispatchCalls, COM calls to the waiting thread are dispatched while
+  // it waits. Threads without COM fall through to the plain wait.
+  bool Wait([[maybe_unused]] bool dispatchCalls = false) {
+#ifdef _WIN32
+    if (!dispatchCalls)
+      return WaitForSingleObject(m_handle, INFINITE) == WAIT_OBJECT_0;
+    DWORD index = 0;
+    return SUCCEEDED(CoWaitForMultipleHandles(
+        COWAIT_INPUTAVAILABLE | COWAIT_DISPATCH_CALLS, INFINITE, 1, &m_handle,
+        &index
+    ));
+#else
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_changed.wait(lock, [this] { return m_set; });
+    if (!m_manualReset) {
+      m_set = false;
+    }
+    return true;
+#endif
+  }
+};
+
+#endif // EVENT_SIGNAL_H
@@ -0,0 +1,87 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "event_worker.h"
+
+#include "sink.h"
+
+static HRESULT ToResult(EventPostResult result) {
+  switch (result) {
+  case EventPostResult::Queued:
+  case EventPostResult::Dropped:
+    return S_OK;
+  case EventPostResult::Coalesced:
+    return S_FALSE;
+  case EventPostResult::Stopped:
+    return E_UNEXPECTED;
+  case EventPostResult::WaitFailed:
+    break;
+  }
+  return E_FAIL;
+}
+
+HostEventWorker::HostEventWorker(
+    size_t capacity, EventOverflow overflow, QThreadPool *pool
+)
+    : m_pool(pool),
+      m_queue(capacity, overflow, this, pool != nullptr) {}
+
+HostEventWorker::~HostEventWorker() { m_queue.Stop(); }
+
+void HostEventWorker::Start() { m_queue.Start(); }
+
+void HostEventWorker::Stop() { m_queue.Stop(); }
+
+HRESULT HostEventWorker::Post(HostEventCall *call) {
+  if (!call)
+    return E_POINTER;
+  return ToResult(m_queue.Post(call));
+}
+
+HRESULT HostEventWorker::PostAsync(HostEventCall *call) {
+  if (!call)
+    return E_POINTER;
+  return ToResult(m_queue.PostAsync(call));
+}
+
+HRESULT HostEventWorker::PostCoalesced(HostEventCall *call) {
+  if (!call)
+    return E_POINTER;
+  return ToResult(m_queue.PostCoalesced(call));
+}
+
+void HostEventWorker::Deliver(HostEventCall *call) {
+  HostEventSink::DeliverInThread(call);
+}
+
+void HostEventWorker::Schedule(std::function<void()> task) {
+  QSharedPointer<HostEventWorker> self = sharedFromThis();
+  m_pool->start([self, task]() { task(); });
+}
+
+quint64 HostEventWorker::GetPostedCount() const {
+  return m_queue.GetPostedCount();
+}
+
+quint64 HostEventWorker::GetDroppedCount() const {
+  return m_queue.GetDroppedCount();
+}
+
+quint64 HostEventWorker::GetQueuedCount() {
+  return EventQueue<HostEventCall>::GetQueuedCount();
+}
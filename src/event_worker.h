@@ -0,0 +1,63 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef EVENT_WORKER_H
+#define EVENT_WORKER_H
+
+#include <functional>
+
+#include <windows.h>
+
+#include <QEnableSharedFromThis>
+#include <QThreadPool>
+
+#include "event_call.h"
+#include "event_queue.h"
+
+// Event queue of a single sink, delivering its calls to the sink's
+// connection in the thread they are taken out in. Drain tasks on the shared
+// pool keep the worker alive until they are done.
+class HostEventWorker : public EventDispatcher<HostEventCall>,
+                        public QEnableSharedFromThis<HostEventWorker> {
+private:
+  QThreadPool *m_pool;
+  EventQueue<HostEventCall> m_queue;
+
+public:
+  HostEventWorker(
+      size_t capacity, EventOverflow overflow, QThreadPool *pool = nullptr
+  );
+  ~HostEventWorker();
+
+  void Start();
+  void Stop();
+
+  HRESULT Post(HostEventCall *call);
+  HRESULT PostAsync(HostEventCall *call);
+  HRESULT PostCoalesced(HostEventCall *call);
+
+  void Deliver(HostEventCall *call) override;
+  void Schedule(std::function<void()> task) override;
+
+  quint64 GetPostedCount() const;
+  quint64 GetDroppedCount() const;
+
+  static quint64 GetQueuedCount();
+};
+
+#endif // EVENT_WORKER_H
@@ -0,0 +1,103 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef EXPIRING_CACHE_H
+#define EXPIRING_CACHE_H
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <utility>
+
+// Cache of resolved values by key. Values the failure predicate holds for
+// are only kept for a while, so a later lookup resolves them again.
+template <typename Key, typename Value> class ExpiringCache {
+public:
+  using Clock = std::chrono::steady_clock;
+
+private:
+  struct Entry {
+    Value value;
+    Clock::time_point created;
+  };
+
+  std::mutex m_mutex;
+  std::map<Key, Entry> m_entries;
+  std::function<bool(const Value &)> m_isFailure;
+  Clock::duration m_failureLifetime;
+
+  bool IsExpired(const Entry &entry) const {
+    return m_isFailure(entry.value) &&
+           Clock::now() - entry.created >= m_failureLifetime;
+  }
+
+  bool Find(const Key &key, Value &value) const {
+    auto search = m_entries.find(key);
+    if (search == m_entries.end() || IsExpired(search->second))
+      return false;
+    value = search->second.value;
+    return true;
+  }
+
+public:
+  ExpiringCache(
+      std::function<bool(const Value &)> isFailure,
+      Clock::duration failureLifetime
+  )
+      : m_isFailure(std::move(isFailure)),
+        m_failureLifetime(failureLifetime) {}
+
+  ExpiringCache(const ExpiringCache &) = delete;
+  ExpiringCache &operator=(const ExpiringCache &) = delete;
+
+  // Calls resolve without holding the lock, since it may take a while. If
+  // another thread got there first, its result is kept.
+  template <typename Resolve> Value Lookup(const Key &key, Resolve resolve) {
+    Value value;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (Find(key, value))
+        return value;
+    }
+    Value resolved = resolve();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (Find(key, value))
+      return value;
+    m_entries[key] = Entry{resolved, Clock::now()};
+    return resolved;
+  }
+
+  void SetFailureLifetime(Clock::duration lifetime) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_failureLifetime = lifetime;
+  }
+
+  void Clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+  }
+
+  std::size_t Size() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+  }
+};
+
+#endif // EXPIRING_CACHE_H
@@ -0,0 +1,234 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "flight_recorder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static constexpr char kMagic[4] = {'A', 'X', 'F', 'R'};
+static constexpr uint32_t kVersion = 1;
+
+struct FlightFileHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t recordSize;
+  uint32_t ringCapacity;
+};
+
+struct FlightRingHeader {
+  uint32_t thread;
+  uint32_t reserved;
+  uint64_t head;
+};
+
+struct FlightRing {
+  std::atomic<bool> inUse{true};
+  std::atomic<uint32_t> thread{0};
+  std::atomic<uint64_t> head{0};
+  FlightRing *next = nullptr;
+  FlightRecord records[FlightRecorder::kRingCapacity];
+};
+
+static std::atomic<bool> g_enabled{true};
+static std::atomic<FlightRing *> g_rings{nullptr};
+
+static uint32_t GetThreadId() {
+#ifdef _WIN32
+  return GetCurrentThreadId();
+#else
+  return static_cast<uint32_t>(syscall(SYS_gettid));
+#endif
+}
+
+static uint64_t GetTime() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch()
+  )
+      .count();
+}
+
+static FlightRing *AcquireRing() {
+  // Rings are never freed, so the list only grows while new threads exceed
+  // the number of finished ones.
+  for (FlightRing *ring = g_rings.load(std::memory_order_acquire); ring;
+       ring = ring->next) {
+    bool expected = false;
+    if (ring->inUse.compare_exchange_strong(expected, true)) {
+      ring->thread = GetThreadId();
+      return ring;
+    }
+  }
+  FlightRing *ring = new FlightRing();
+  ring->thread = GetThreadId();
+  ring->next = g_rings.load(std::memory_order_relaxed);
+  while (!g_rings.compare_exchange_weak(
+      ring->next, ring, std::memory_order_release, std::memory_order_relaxed
+  )) {
+  }
+  return ring;
+}
+
+// Hands the ring back when its thread ends. The records stay until another
+// thread overwrites them.
+struct FlightRingOwner {
+  FlightRing *ring = nullptr;
+
+  ~FlightRingOwner() {
+    if (ring) {
+      ring->inUse.store(false, std::memory_order_release);
+    }
+  }
+};
+
+static FlightRing *GetThreadRing() {
+  thread_local FlightRingOwner owner;
+  if (!owner.ring) {
+    owner.ring = AcquireRing();
+  }
+  return owner.ring;
+}
+
+void FlightRecorder::SetEnabled(bool enabled) { g_enabled = enabled; }
+
+bool FlightRecorder::IsEnabled() { return g_enabled; }
+
+void FlightRecorder::Record(FlightEvent event, uint64_t a, uint64_t b) {
+  if (!g_enabled.load(std::memory_order_relaxed))
+    return;
+  FlightRing *ring = GetThreadRing();
+  uint64_t head = ring->head.load(std::memory_order_relaxed);
+  FlightRecord &record = ring->records[head % kRingCapacity];
+  record.time = GetTime();
+  record.thread = ring->thread.load(std::memory_order_relaxed);
+  record.event = static_cast<uint16_t>(event);
+  record.reserved = 0;
+  record.a = a;
+  record.b = b;
+  ring->head.store(head + 1, std::memory_order_release);
+}
+
+bool FlightRecorder::Dump(std::ostream &out) {
+  FlightFileHeader header = {};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.recordSize = sizeof(FlightRecord);
+  header.ringCapacity = kRingCapacity;
+  out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  // Threads keep writing while the rings are copied, so the oldest records
+  // of a busy ring may already be newer than its head suggests.
+  for (FlightRing *ring = g_rings.load(std::memory_order_acquire); ring;
+       ring = ring->next) {
+    FlightRingHeader ringHeader = {};
+    ringHeader.thread = ring->thread.load(std::memory_order_relaxed);
+    ringHeader.head = ring->head.load(std::memory_order_acquire);
+    out.write(reinterpret_cast<const char *>(&ringHeader), sizeof(ringHeader));
+    out.write(
+        reinterpret_cast<const char *>(ring->records), sizeof(ring->records)
+    );
+  }
+  out.flush();
+  return bool(out);
+}
+
+bool FlightRecorder::Dump(const std::string &path) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out)
+    return false;
+  return Dump(out);
+}
+
+bool FlightRecorder::Decode(std::istream &in, std::ostream &out) {
+  FlightFileHeader header = {};
+  if (!in.read(reinterpret_cast<char *>(&header), sizeof(header)))
+    return false;
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != kVersion ||
+      header.recordSize != sizeof(FlightRecord) || header.ringCapacity == 0)
+    return false;
+
+  std::vector<FlightRecord> records;
+  std::vector<FlightRecord> ring(header.ringCapacity);
+  FlightRingHeader ringHeader = {};
+  while (in.read(reinterpret_cast<char *>(&ringHeader), sizeof(ringHeader))) {
+    if (!in.read(
+            reinterpret_cast<char *>(ring.data()),
+            std::streamsize(ring.size() * sizeof(FlightRecord))
+        ))
+      return false;
+    uint64_t count = std::min<uint64_t>(ringHeader.head, ring.size());
+    for (uint64_t i = ringHeader.head - count; i < ringHeader.head; ++i) {
+      const FlightRecord &record = ring[i % ring.size()];
+      if (record.event != static_cast<uint16_t>(FlightEvent::None)) {
+        records.push_back(record);
+      }
+    }
+  }
+  std::stable_sort(
+      records.begin(), records.end(),
+      [](const FlightRecord &left, const FlightRecord &right) {
+        return left.time < right.time;
+      }
+  );
+
+  uint64_t start = records.empty() ? 0 : records.front().time;
+  for (const FlightRecord &record : records) {
+    out << std::setw(14) << std::fixed << std::setprecision(3)
+        << (record.time - start) / 1000.0 << " us  thread " << std::setw(6)
+        << record.thread << "  " << std::left << std::setw(24)
+        << EventName(record.event) << std::right << std::hex << "  0x"
+        << record.a << "  0x" << record.b << std::dec << "\n";
+  }
+  return bool(out);
+}
+
+const char *FlightRecorder::EventName(uint16_t event) {
+  switch (static_cast<FlightEvent>(event)) {
+  case FlightEvent::None:
+    return "None";
+  case FlightEvent::ActivationBegin:
+    return "ActivationBegin";
+  case FlightEvent::ActivationEnd:
+    return "ActivationEnd";
+  case FlightEvent::EventDelivery:
+    return "EventDelivery";
+  case FlightEvent::ContainerAddRef:
+    return "ContainerAddRef";
+  case FlightEvent::ContainerRelease:
+    return "ContainerRelease";
+  case FlightEvent::ServerReferenceAdded:
+    return "ServerReferenceAdded";
+  case FlightEvent::ServerReferenceReleased:
+    return "ServerReferenceReleased";
+  }
+  return "Unknown";
+}
@@ -0,0 +1,69 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+enum class FlightEvent : uint16_t {
+  None = 0,
+  ActivationBegin,
+  ActivationEnd,
+  EventDelivery,
+  ContainerAddRef,
+  ContainerRelease,
+  ServerReferenceAdded,
+  ServerReferenceReleased,
+};
+
+// One fixed-size binary record. What 'a' and 'b' hold depends on the event:
+// a CLSID prefix and an HRESULT, a DISPID and a duration in nanoseconds, or
+// an object address and its new reference count.
+struct FlightRecord {
+  uint64_t time;
+  uint32_t thread;
+  uint16_t event;
+  uint16_t reserved;
+  uint64_t a;
+  uint64_t b;
+};
+
+// Always-on trace of the last events of every thread. Each thread writes to
+// a ring of its own without locking; rings of finished threads are reused
+// by new ones. Dumps are read back with Decode. Only standard C++ is used,
+// so the recorder and the decoder also build on other platforms.
+class FlightRecorder {
+public:
+  static constexpr uint32_t kRingCapacity = 4096;
+
+  static void SetEnabled(bool enabled);
+  static bool IsEnabled();
+
+  static void Record(FlightEvent event, uint64_t a = 0, uint64_t b = 0);
+
+  static bool Dump(std::ostream &out);
+  static bool Dump(const std::string &path);
+  static bool Decode(std::istream &in, std::ostream &out);
+
+  static const char *EventName(uint16_t event);
+};
+
+#endif // FLIGHT_RECORDER_H
@@ -0,0 +1,92 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef HANDLE_POOL_H
+#define HANDLE_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+// Handles created and handed out again by the pools of all threads.
+struct HandlePoolCounts {
+  std::atomic<uint64_t> created{0};
+  std::atomic<uint64_t> reused{0};
+};
+
+// Free list of the handles of one thread. A handle released while the list
+// is at its limit is closed instead of being kept.
+template <typename Handle> class HandlePool {
+private:
+  std::size_t m_limit;
+  HandlePoolCounts *m_counts;
+  std::function<Handle()> m_create;
+  std::function<void(Handle)> m_close;
+  std::vector<Handle> m_handles;
+
+public:
+  HandlePool(
+      std::size_t limit, HandlePoolCounts *counts,
+      std::function<Handle()> create, std::function<void(Handle)> close
+  )
+      : m_limit(limit),
+        m_counts(counts),
+        m_create(std::move(create)),
+        m_close(std::move(close)) {}
+
+  ~HandlePool() {
+    for (Handle handle : m_handles) {
+      m_close(handle);
+    }
+  }
+
+  HandlePool(const HandlePool &) = delete;
+  HandlePool &operator=(const HandlePool &) = delete;
+
+  // Returns an empty handle when a new one cannot be created.
+  Handle Acquire() {
+    if (!m_handles.empty()) {
+      Handle handle = m_handles.back();
+      m_handles.pop_back();
+      ++m_counts->reused;
+      return handle;
+    }
+    Handle handle = m_create();
+    if (handle) {
+      ++m_counts->created;
+    }
+    return handle;
+  }
+
+  void Release(Handle handle) {
+    if (!handle)
+      return;
+    if (m_handles.size() < m_limit) {
+      m_handles.push_back(handle);
+    } else {
+      m_close(handle);
+    }
+  }
+
+  std::size_t Size() const { return m_handles.size(); }
+};
+
+#endif // HANDLE_POOL_H
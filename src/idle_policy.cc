@@ -0,0 +1,88 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "idle_policy.h"
+
+#include <algorithm>
+
+// IdlePolicy implementation
+
+IdlePolicy::IdlePolicy(qint64 timeout)
+    : m_timeout(timeout) {}
+
+qint64 IdlePolicy::timeout() const { return m_timeout; }
+
+void IdlePolicy::OnActivation() { m_lastActivation.start(); }
+
+bool IdlePolicy::HasActivation() const { return m_lastActivation.isValid(); }
+
+IdlePolicy *
+IdlePolicy::create(const QString &name, qint64 timeout, qint64 window) {
+  if (name.isEmpty() || name == "fixed") {
+    return new FixedIdlePolicy(timeout);
+  } else if (name == "hysteresis") {
+    return new HysteresisIdlePolicy(timeout, window);
+  } else if (name == "keep-warm") {
+    return new KeepWarmIdlePolicy(timeout);
+  } else if (name == "exit-on-last-release") {
+    return new ExitOnLastReleaseIdlePolicy(timeout);
+  }
+  return nullptr;
+}
+
+// FixedIdlePolicy implementation
+
+QString FixedIdlePolicy::name() const { return "fixed"; }
+
+qint64 FixedIdlePolicy::RemainingIdleTime(qint64 idle) const {
+  return std::max<qint64>(m_timeout - idle, 0);
+}
+
+// HysteresisIdlePolicy implementation
+
+HysteresisIdlePolicy::HysteresisIdlePolicy(qint64 timeout, qint64 window)
+    : IdlePolicy(timeout),
+      m_window(window) {}
+
+QString HysteresisIdlePolicy::name() const { return "hysteresis"; }
+
+qint64 HysteresisIdlePolicy::RemainingIdleTime(qint64 idle) const {
+  qint64 remaining = m_timeout - idle;
+  if (HasActivation()) {
+    remaining = std::max(remaining, m_window - m_lastActivation.elapsed());
+  }
+  return std::max<qint64>(remaining, 0);
+}
+
+// KeepWarmIdlePolicy implementation
+
+QString KeepWarmIdlePolicy::name() const { return "keep-warm"; }
+
+qint64 KeepWarmIdlePolicy::RemainingIdleTime(qint64) const { return -1; }
+
+// ExitOnLastReleaseIdlePolicy implementation
+
+QString ExitOnLastReleaseIdlePolicy::name() const {
+  return "exit-on-last-release";
+}
+
+qint64 ExitOnLastReleaseIdlePolicy::RemainingIdleTime(qint64 idle) const {
+  if (HasActivation())
+    return 0;
+  return std::max<qint64>(m_timeout - idle, 0);
+}
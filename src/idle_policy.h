@@ -0,0 +1,92 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef IDLE_POLICY_H
+#define IDLE_POLICY_H
+
+#include <QElapsedTimer>
+#include <QString>
+
+// Decides how long the host stays alive once no COM object is in use.
+class IdlePolicy {
+protected:
+  qint64 m_timeout;
+  QElapsedTimer m_lastActivation;
+
+public:
+  IdlePolicy(qint64 timeout);
+  virtual ~IdlePolicy() = default;
+
+  virtual QString name() const = 0;
+  qint64 timeout() const;
+
+  void OnActivation();
+  bool HasActivation() const;
+
+  // Returns how much longer the process should wait after it has been idle
+  // for 'idle' milliseconds: 0 to exit now, or a negative value to stay
+  // until something else ends the process.
+  virtual qint64 RemainingIdleTime(qint64 idle) const = 0;
+
+public:
+  static IdlePolicy *
+  create(const QString &name, qint64 timeout, qint64 window = 0);
+};
+
+// Exits once the process has been idle for the timeout.
+class FixedIdlePolicy : public IdlePolicy {
+public:
+  using IdlePolicy::IdlePolicy;
+
+  QString name() const override;
+  qint64 RemainingIdleTime(qint64 idle) const override;
+};
+
+// Like the fixed timeout, but also stays alive while the last activation
+// is more recent than the window, so bursty clients find a warm process.
+class HysteresisIdlePolicy : public IdlePolicy {
+private:
+  qint64 m_window;
+
+public:
+  HysteresisIdlePolicy(qint64 timeout, qint64 window);
+
+  QString name() const override;
+  qint64 RemainingIdleTime(qint64 idle) const override;
+};
+
+// Never exits because of idleness.
+class KeepWarmIdlePolicy : public IdlePolicy {
+public:
+  using IdlePolicy::IdlePolicy;
+
+  QString name() const override;
+  qint64 RemainingIdleTime(qint64 idle) const override;
+};
+
+// Exits as soon as the last object is released. Until the first activation,
+// the timeout still applies.
+class ExitOnLastReleaseIdlePolicy : public IdlePolicy {
+public:
+  using IdlePolicy::IdlePolicy;
+
+  QString name() const override;
+  qint64 RemainingIdleTime(qint64 idle) const override;
+};
+
+#endif // IDLE_POLICY_H
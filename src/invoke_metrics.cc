@@ -0,0 +1,238 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "invoke_metrics.h"
+
+#include <algorithm>
+#include <bit>
+#include <map>
+#include <memory>
+#include <utility>
+
+#include <windows.h>
+
+#include <atlcomcli.h>
+#include <oaidl.h>
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QReadLocker>
+#include <QReadWriteLock>
+#include <QString>
+#include <QTimer>
+#include <QUuid>
+#include <QWriteLocker>
+
+#include "spdlog/spdlog.h"
+
+namespace {
+
+struct InvokeMethod {
+  QUuid classId;
+  DISPID dispId = DISPID_UNKNOWN;
+  QString name;
+  InvokeHistogram histogram;
+  // Counts at the previous report, only touched by the reporting thread.
+  InvokeHistogram::Counts reported{};
+};
+
+} // namespace
+
+static QReadWriteLock g_methodsLock;
+static std::map<std::pair<QUuid, DISPID>, std::unique_ptr<InvokeMethod>>
+    g_methods;
+
+static QString g_metricsFile;
+static QTimer *g_reportTimer = nullptr;
+
+// InvokeHistogram implementation
+
+void InvokeHistogram::Record(quint64 nanoseconds) {
+  m_counts[BucketIndex(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void InvokeHistogram::Snapshot(Counts &counts) const {
+  for (int i = 0; i < kBucketCount; ++i) {
+    counts[i] = m_counts[i].load(std::memory_order_relaxed);
+  }
+}
+
+int InvokeHistogram::BucketIndex(quint64 value) {
+  value = std::min<quint64>(value, (quint64(1) << kMaxValueBits) - 1);
+  // Values below 2 * kSubBuckets get a bucket each. Above that, the shift
+  // drops the bits below the resolution of the value's power of two.
+  int shift = std::max(
+      0, static_cast<int>(std::bit_width(value)) - (kSubBucketBits + 1)
+  );
+  return shift * kSubBuckets + static_cast<int>(value >> shift);
+}
+
+quint64 InvokeHistogram::BucketUpperBound(int index) {
+  if (index < 2 * kSubBuckets)
+    return index;
+  int shift = index / kSubBuckets - 1;
+  quint64 sub = index % kSubBuckets + kSubBuckets;
+  return ((sub + 1) << shift) - 1;
+}
+
+quint64 InvokeHistogram::Percentile(const Counts &counts, double quantile) {
+  quint64 total = 0;
+  for (quint64 count : counts) {
+    total += count;
+  }
+  if (total == 0)
+    return 0;
+  quint64 rank = std::max<quint64>(
+      1, static_cast<quint64>(quantile * static_cast<double>(total) + 0.5)
+  );
+  quint64 seen = 0;
+  for (int i = 0; i < kBucketCount; ++i) {
+    seen += counts[i];
+    if (seen >= rank)
+      return BucketUpperBound(i);
+  }
+  return BucketUpperBound(kBucketCount - 1);
+}
+
+quint64 InvokeHistogram::Maximum(const Counts &counts) {
+  for (int i = kBucketCount - 1; i >= 0; --i) {
+    if (counts[i] > 0)
+      return BucketUpperBound(i);
+  }
+  return 0;
+}
+
+// InvokeMetrics implementation
+
+static QString ResolveMethodName(IDispatch *dispatch, DISPID dispId) {
+  CComPtr<ITypeInfo> typeInfo;
+  if (dispatch &&
+      SUCCEEDED(dispatch->GetTypeInfo(0, LOCALE_USER_DEFAULT, &typeInfo))) {
+    CComBSTR name;
+    UINT count = 0;
+    if (SUCCEEDED(typeInfo->GetNames(dispId, &name, 1, &count)) && count > 0)
+      return QString::fromWCharArray(name, name.Length());
+  }
+  return QString("DISPID %1").arg(dispId);
+}
+
+InvokeHistogram *InvokeMetrics::GetHistogram(
+    const QUuid &classId, DISPID dispId, IDispatch *dispatch
+) {
+  std::pair<QUuid, DISPID> key(classId, dispId);
+  {
+    QReadLocker locker(&g_methodsLock);
+    auto it = g_methods.find(key);
+    if (it != g_methods.end())
+      return &it->second->histogram;
+  }
+  // Resolved outside the lock, the type info may have to be loaded.
+  auto method = std::make_unique<InvokeMethod>();
+  method->classId = classId;
+  method->dispId = dispId;
+  method->name = ResolveMethodName(dispatch, dispId);
+  QWriteLocker locker(&g_methodsLock);
+  std::unique_ptr<InvokeMethod> &slot = g_methods[key];
+  if (!slot) {
+    slot = std::move(method);
+  }
+  return &slot->histogram;
+}
+
+void InvokeMetrics::StartReporting(int intervalSeconds, const QString &file) {
+  // Pool children and farm workers share the command line, so the file
+  // name can contain the process id.
+  g_metricsFile = file;
+  g_metricsFile.replace("{pid}", QString::number(GetCurrentProcessId()));
+  if (!g_reportTimer) {
+    QCoreApplication *app = QCoreApplication::instance();
+    g_reportTimer = new QTimer(app);
+    QObject::connect(g_reportTimer, &QTimer::timeout, &InvokeMetrics::Report);
+    QObject::connect(
+        app, &QCoreApplication::aboutToQuit, &InvokeMetrics::Report
+    );
+  }
+  if (intervalSeconds > 0) {
+    g_reportTimer->start(intervalSeconds * 1000);
+  }
+}
+
+void InvokeMetrics::Report() {
+  QJsonArray entries;
+  {
+    QReadLocker locker(&g_methodsLock);
+    for (const auto &[key, method] : g_methods) {
+      InvokeHistogram::Counts counts;
+      InvokeHistogram::Counts interval;
+      method->histogram.Snapshot(counts);
+      quint64 calls = 0;
+      quint64 total = 0;
+      for (int i = 0; i < InvokeHistogram::kBucketCount; ++i) {
+        interval[i] = counts[i] - method->reported[i];
+        calls += interval[i];
+        total += counts[i];
+      }
+      method->reported = counts;
+      if (calls == 0)
+        continue;
+
+      double p50 = InvokeHistogram::Percentile(interval, 0.5) / 1000.0;
+      double p99 = InvokeHistogram::Percentile(interval, 0.99) / 1000.0;
+      double p999 = InvokeHistogram::Percentile(interval, 0.999) / 1000.0;
+      spdlog::info(
+          "Invoke {} {}: {} calls, p50 {:.1f} us, p99 {:.1f} us, "
+          "p999 {:.1f} us",
+          method->classId.toString().toStdString(),
+          method->name.toStdString(), calls, p50, p99, p999
+      );
+
+      QJsonObject entry;
+      entry["clsid"] = method->classId.toString();
+      entry["dispid"] = static_cast<qint64>(method->dispId);
+      entry["name"] = method->name;
+      entry["calls"] = static_cast<qint64>(calls);
+      entry["total"] = static_cast<qint64>(total);
+      entry["p50_us"] = p50;
+      entry["p99_us"] = p99;
+      entry["p999_us"] = p999;
+      entries.append(entry);
+    }
+  }
+
+  if (g_metricsFile.isEmpty() || entries.isEmpty())
+    return;
+
+  // One line per report, so the file keeps the history.
+  QJsonObject report;
+  report["time"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODateWithMs);
+  report["pid"] = static_cast<qint64>(GetCurrentProcessId());
+  report["methods"] = entries;
+  QFile file(g_metricsFile);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+    spdlog::warn(
+        "Could not write invoke metrics to {}", g_metricsFile.toStdString()
+    );
+    return;
+  }
+  file.write(QJsonDocument(report).toJson(QJsonDocument::Compact));
+  file.write("\n");
+}
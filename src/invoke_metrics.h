@@ -0,0 +1,73 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef INVOKE_METRICS_H
+#define INVOKE_METRICS_H
+
+#include <array>
+#include <atomic>
+
+#include <windows.h>
+
+#include <oaidl.h>
+
+#include <QString>
+#include <QUuid>
+
+// Latency histogram with logarithmic buckets in the style of HdrHistogram.
+// Values are nanoseconds. Each power of two is split into kSubBuckets
+// linear buckets, which keeps the relative error of a percentile below
+// 1/kSubBuckets. Recording is one relaxed atomic increment, so any thread
+// can record while another one reads.
+class InvokeHistogram {
+public:
+  static constexpr int kSubBucketBits = 5;
+  static constexpr int kSubBuckets = 1 << kSubBucketBits;
+  static constexpr int kMaxValueBits = 40;
+  static constexpr int kBucketCount =
+      (kMaxValueBits - kSubBucketBits + 1) * kSubBuckets;
+
+  using Counts = std::array<quint64, kBucketCount>;
+
+private:
+  std::array<std::atomic<quint64>, kBucketCount> m_counts{};
+
+public:
+  void Record(quint64 nanoseconds);
+  void Snapshot(Counts &counts) const;
+
+  static int BucketIndex(quint64 value);
+  static quint64 BucketUpperBound(int index);
+  static quint64 Percentile(const Counts &counts, double quantile);
+  static quint64 Maximum(const Counts &counts);
+};
+
+// Invoke latencies of every profiled method, keyed by class and DISPID.
+// Method names are resolved once, when a method is first called, and the
+// collected percentiles are written to the log and an optional metrics
+// file at a fixed interval.
+class InvokeMetrics {
+public:
+  static InvokeHistogram *
+  GetHistogram(const QUuid &classId, DISPID dispId, IDispatch *dispatch);
+
+  static void StartReporting(int intervalSeconds, const QString &file);
+  static void Report();
+};
+
+#endif // INVOKE_METRICS_H
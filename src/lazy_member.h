@@ -0,0 +1,54 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef LAZY_MEMBER_H
+#define LAZY_MEMBER_H
+
+#include <atomic>
+#include <cstdint>
+
+// A member created on first use, with the creations of all members sharing
+// one counter counted. It belongs to one thread, like the apartment-threaded
+// object holding it.
+template <typename Pointer> class LazyMember {
+private:
+  std::atomic<uint64_t> *m_count;
+  Pointer m_value;
+
+public:
+  explicit LazyMember(std::atomic<uint64_t> *count) : m_count(count) {}
+
+  LazyMember(const LazyMember &) = delete;
+  LazyMember &operator=(const LazyMember &) = delete;
+
+  // Calls create when there is no value yet. An empty value is a failed
+  // creation and is tried again by the next call.
+  template <typename Create> const Pointer &Get(Create create) {
+    if (!m_value) {
+      m_value = create();
+      if (m_value)
+        ++*m_count;
+    }
+    return m_value;
+  }
+
+  // The value, without creating it.
+  const Pointer &Peek() const { return m_value; }
+};
+
+#endif // LAZY_MEMBER_H
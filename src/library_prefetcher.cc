@@ -0,0 +1,83 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "library_prefetcher.h"
+
+#include <algorithm>
+#include <string>
+
+#include <QElapsedTimer>
+#include <QThread>
+#include <QThreadPool>
+
+#include "com_initialize_context.h"
+#include "registry_helper.h"
+#include "type_info_cache.h"
+
+HostLibraryPrefetcher::~HostLibraryPrefetcher() {
+  for (Result &result : m_results) {
+    if (result.module) {
+      FreeLibrary(result.module);
+      result.module = nullptr;
+    }
+  }
+}
+
+void HostLibraryPrefetcher::PrefetchOne(Result &result) {
+  QElapsedTimer timer;
+  timer.start();
+  ComInitializeContext com(COINIT_MULTITHREADED);
+  result.result = ReadInprocServerPath(result.clsid, &result.path);
+  if (SUCCEEDED(result.result)) {
+    std::wstring path = result.path.toStdWString();
+    DWORD flags =
+        result.path.contains('\\') ? LOAD_WITH_ALTERED_SEARCH_PATH : 0;
+    result.module = LoadLibraryExW(path.c_str(), nullptr, flags);
+    if (!result.module) {
+      result.result = HRESULT_FROM_WIN32(GetLastError());
+    }
+  }
+  if (SUCCEEDED(result.result)) {
+    // Type libraries are free-threaded, so their loading can be moved off
+    // the main thread as well.
+    HostTypeInfoCache::Lookup(result.clsid);
+  }
+  result.elapsed = timer.elapsed();
+}
+
+void HostLibraryPrefetcher::Prefetch(const QList<ClassSpec> &specs) {
+  m_results.resize(specs.size());
+  QThreadPool pool;
+  pool.setMaxThreadCount(
+      std::max(1, std::min(QThread::idealThreadCount(), int(specs.size())))
+  );
+  for (qsizetype i = 0; i < specs.size(); ++i) {
+    const ClassSpec &spec = specs[i];
+    Result &result = m_results[i];
+    result.clsid = spec.clsid;
+    if (!(spec.clsctx_create & CLSCTX_INPROC_SERVER))
+      continue;
+    pool.start([&result] { PrefetchOne(result); });
+  }
+  pool.waitForDone();
+}
+
+const HostLibraryPrefetcher::Result &
+HostLibraryPrefetcher::GetResult(qsizetype index) const {
+  return m_results[index];
+}
@@ -0,0 +1,57 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef LIBRARY_PREFETCHER_H
+#define LIBRARY_PREFETCHER_H
+
+#include <windows.h>
+
+#include <QList>
+#include <QString>
+#include <QUuid>
+
+#include "class_spec.h"
+
+// Loads the InProc server DLLs of a list of classes on MTA worker threads,
+// so that the class objects can then be resolved and registered on the main
+// thread without paying for the DLL loads one after another. The modules
+// are kept loaded until the prefetcher is destroyed.
+class HostLibraryPrefetcher {
+public:
+  struct Result {
+    QUuid clsid;
+    QString path;
+    HMODULE module = nullptr;
+    HRESULT result = S_FALSE;
+    qint64 elapsed = 0;
+  };
+
+private:
+  QList<Result> m_results;
+
+private:
+  static void PrefetchOne(Result &result);
+
+public:
+  ~HostLibraryPrefetcher();
+
+  void Prefetch(const QList<ClassSpec> &specs);
+  const Result &GetResult(qsizetype index) const;
+};
+
+#endif // LIBRARY_PREFETCHER_H
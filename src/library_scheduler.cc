@@ -0,0 +1,149 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "library_scheduler.h"
+
+#include <string>
+
+#include "spdlog/spdlog.h"
+
+#include "registry_helper.h"
+
+HostLibraryScheduler::HostLibraryScheduler(QObject *parent)
+    : QObject(parent) {
+  m_clock.start();
+  m_sweepTimer.setSingleShot(true);
+  connect(
+      &m_sweepTimer, &QTimer::timeout, this, &HostLibraryScheduler::Sweep
+  );
+  m_sweepTimer.start(m_idleStretch);
+}
+
+HostLibraryScheduler::~HostLibraryScheduler() {
+  spdlog::debug(
+      "Library scheduler: {} sweeps, {} reloads", m_sweepCount, m_reloadCount
+  );
+  for (Library &library : m_libraries) {
+    if (library.pinned) {
+      FreeLibrary(library.pinned);
+      library.pinned = nullptr;
+    }
+  }
+}
+
+QString HostLibraryScheduler::GetLibraryPath(const QUuid &clsid) {
+  auto search = m_paths.constFind(clsid);
+  if (search != m_paths.constEnd())
+    return search.value();
+  QString path;
+  if (FAILED(ReadInprocServerPath(clsid, &path))) {
+    path.clear();
+  }
+  path = path.toLower();
+  m_paths.insert(clsid, path);
+  return path;
+}
+
+bool HostLibraryScheduler::IsHot(const Library &library) const {
+  if (library.activations.empty())
+    return false;
+  if (int(library.activations.size()) >= kHotActivationCount)
+    return true;
+  return library.reloadCount > 0 &&
+         library.reloadCost / qint64(library.reloadCount) >= kExpensiveReload;
+}
+
+void HostLibraryScheduler::UpdatePins() {
+  qint64 now = m_clock.elapsed();
+  for (auto it = m_libraries.begin(); it != m_libraries.end(); ++it) {
+    Library &library = it.value();
+    while (!library.activations.empty() &&
+           now - library.activations.front() > kHotWindow) {
+      library.activations.pop_front();
+    }
+    bool hot = IsHot(library);
+    if (hot && !library.pinned) {
+      std::wstring path = it.key().toStdWString();
+      DWORD flags =
+          it.key().contains('\\') ? LOAD_WITH_ALTERED_SEARCH_PATH : 0;
+      library.pinned = LoadLibraryExW(path.c_str(), nullptr, flags);
+    } else if (!hot && library.pinned) {
+      FreeLibrary(library.pinned);
+      library.pinned = nullptr;
+    }
+  }
+}
+
+void HostLibraryScheduler::SetIdleStretch(qint64 stretch) {
+  if (stretch <= 0)
+    return;
+  m_idleStretch = stretch;
+  m_sweepTimer.start(m_idleStretch);
+}
+
+HostLibraryScheduler::Activation
+HostLibraryScheduler::BeginActivation(const QUuid &clsid) {
+  Activation activation;
+  activation.path = GetLibraryPath(clsid);
+  if (!activation.path.isEmpty()) {
+    std::wstring path = activation.path.toStdWString();
+    HMODULE module = nullptr;
+    activation.reload = !GetModuleHandleExW(
+        GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT, path.c_str(), &module
+    );
+  }
+  activation.timer.start();
+  // An activation ends the idle stretch.
+  m_sweepTimer.start(m_idleStretch);
+  return activation;
+}
+
+void HostLibraryScheduler::EndActivation(const Activation &activation) {
+  if (activation.path.isEmpty())
+    return;
+  Library &library = m_libraries[activation.path];
+  library.activations.push_back(m_clock.elapsed());
+  ++library.activationCount;
+  if (activation.reload && library.activationCount > 1) {
+    // The first activation loads the DLL anyway; later loads are churn.
+    ++library.reloadCount;
+    library.reloadCost += activation.timer.elapsed();
+    ++m_reloadCount;
+  }
+}
+
+quint64 HostLibraryScheduler::GetSweepCount() const { return m_sweepCount; }
+
+quint64 HostLibraryScheduler::GetReloadCount() const { return m_reloadCount; }
+
+void HostLibraryScheduler::Sweep() {
+  UpdatePins();
+  ::CoFreeUnusedLibraries();
+  ++m_sweepCount;
+  int pinned = 0;
+  for (const Library &library : m_libraries) {
+    if (library.pinned)
+      ++pinned;
+  }
+  spdlog::debug(
+      "Library sweep: {} libraries tracked, {} kept resident, {} reloads so "
+      "far",
+      m_libraries.size(), pinned, m_reloadCount
+  );
+  m_sweepTimer.start(m_idleStretch);
+}
@@ -0,0 +1,92 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef LIBRARY_SCHEDULER_H
+#define LIBRARY_SCHEDULER_H
+
+#include <deque>
+
+#include <windows.h>
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QUuid>
+
+// Decides when to let COM unload InProc server DLLs. Activations are
+// tracked per DLL; a DLL that is activated often, or that was found
+// unloaded at activation and took long to come back, is kept resident by
+// holding an extra module reference. The CoFreeUnusedLibraries sweep only
+// runs after no activation has happened for the idle stretch.
+class HostLibraryScheduler : public QObject {
+  Q_OBJECT
+
+public:
+  struct Activation {
+    QString path;
+    bool reload = false;
+    QElapsedTimer timer;
+  };
+
+private:
+  struct Library {
+    HMODULE pinned = nullptr;
+    std::deque<qint64> activations;
+    quint64 activationCount = 0;
+    quint64 reloadCount = 0;
+    qint64 reloadCost = 0;
+  };
+
+  static constexpr qint64 kHotWindow = 10 * 60 * 1000;
+  static constexpr int kHotActivationCount = 3;
+  static constexpr qint64 kExpensiveReload = 100;
+
+  QElapsedTimer m_clock;
+  QTimer m_sweepTimer;
+  qint64 m_idleStretch = 60000;
+
+  QHash<QUuid, QString> m_paths;
+  QHash<QString, Library> m_libraries;
+
+  quint64 m_sweepCount = 0;
+  quint64 m_reloadCount = 0;
+
+private:
+  QString GetLibraryPath(const QUuid &clsid);
+  bool IsHot(const Library &library) const;
+  void UpdatePins();
+
+public:
+  HostLibraryScheduler(QObject *parent = nullptr);
+  ~HostLibraryScheduler();
+
+  void SetIdleStretch(qint64 stretch);
+
+  Activation BeginActivation(const QUuid &clsid);
+  void EndActivation(const Activation &activation);
+
+  quint64 GetSweepCount() const;
+  quint64 GetReloadCount() const;
+
+public slots:
+  void Sweep();
+};
+
+#endif // LIBRARY_SCHEDULER_H
@@ -18,8 +18,12 @@
 
 #include "logging.h"
 
+#include <algorithm>
 #include <exception>
+#include <fstream>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include <windows.h>
 
@@ -27,19 +31,38 @@
 #include <wil/result.h>
 
 #include <QCoreApplication>
+#include <QDateTime>
 #include <QDir>
+#include <QFile>
+#include <QFileInfo>
 #include <QMessageBox>
 #include <QStandardPaths>
 #include <QString>
+#include <QStringList>
 #include <QtLogging>
 
+#include "spdlog/async.h"
 #include "spdlog/sinks/basic_file_sink.h"
+#include "spdlog/sinks/rotating_file_sink.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
 #include "spdlog/spdlog.h"
 
 #include "command_line_parser.h"
+#include "flight_recorder.h"
 #include "registry_helper.h"
 
+// Milliseconds DrainLogging waits for the async queue to empty.
+static constexpr int kMaxDrainWait = 2000;
+
+// Single-use hosts start often, so the log directory is swept at most
+// once per interval, tracked by the time stamp of a marker file.
+static constexpr qint64 kRetentionSweepInterval = 60 * 60;
+
+// Prepared up front, so the crash handlers do not have to build it.
+static std::string g_flightRecordPath;
+static wil::unique_event g_flightRecordEvent;
+static HANDLE g_flightRecordWait = nullptr;
+
 terminate_handler OriginalTerminateHandler;
 LPTOP_LEVEL_EXCEPTION_FILTER OriginalExceptionFilter;
 QtMessageHandler OriginalMessageHandler;
@@ -80,6 +103,117 @@ QString GetLogFilename(const QString &directory = QString()) {
   return filepath;
 }
 
+void SweepLogDirectory(const QString &directory, int retentionDays) {
+  if (retentionDays <= 0)
+    return;
+
+  QDir dir(directory.isEmpty() ? GetLogDirectory() : directory);
+  QString name = GetLoggerName();
+  QDateTime now = QDateTime::currentDateTimeUtc();
+
+  QFileInfo marker(dir.filePath(name + ".sweep"));
+  if (marker.exists() &&
+      marker.lastModified().toUTC().secsTo(now) < kRetentionSweepInterval)
+    return;
+  QFile markerFile(marker.filePath());
+  if (markerFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    markerFile.write(now.toString(Qt::ISODate).toUtf8());
+    markerFile.close();
+  }
+
+  // Matches rotated files like axhost-1234.1.log, flight recorder dumps
+  // and their decoded text.
+  QStringList filters = {name + "-*.log", name + "-*.flight*"};
+  QString ownPrefix = QString("%1-%2.").arg(name).arg(GetCurrentProcessId());
+  QDateTime cutoff = now.addDays(-retentionDays);
+
+  int removed = 0;
+  const QFileInfoList files =
+      dir.entryInfoList(filters, QDir::Files | QDir::NoDotAndDotDot);
+  for (const QFileInfo &file : files) {
+    if (file.fileName().startsWith(ownPrefix))
+      continue;
+    if (file.lastModified().toUTC() >= cutoff)
+      continue;
+    // Files still open by a running host fail to delete and are skipped.
+    if (QFile::remove(file.filePath())) {
+      ++removed;
+    }
+  }
+  spdlog::debug(
+      "Log retention removed {} of {} files older than {} days", removed,
+      files.size(), retentionDays
+  );
+}
+
+// Global, so that a dump can be requested from another session, like the
+// console of an administrator while the host runs in a service session.
+QString GetFlightRecordEventName(DWORD pid) {
+  return QString("Global\\AxHost_FlightRecord_%1").arg(pid);
+}
+
+void SetFlightRecordDirectory(const QString &directory) {
+  QDir dir(directory.isEmpty() ? GetLogDirectory() : directory);
+  if (!dir.exists()) {
+    dir.mkpath(".");
+  }
+  QString filename =
+      QString("%1-%2.flight").arg(GetLoggerName()).arg(GetCurrentProcessId());
+  g_flightRecordPath = QDir::toNativeSeparators(dir.filePath(filename))
+                           .toLocal8Bit()
+                           .toStdString();
+}
+
+QString DumpFlightRecord() {
+  if (g_flightRecordPath.empty() ||
+      !FlightRecorder::Dump(g_flightRecordPath))
+    return QString();
+  return QString::fromLocal8Bit(g_flightRecordPath.c_str());
+}
+
+bool RequestFlightRecordDump(DWORD pid) {
+  std::wstring name = GetFlightRecordEventName(pid).toStdWString();
+  wil::unique_event event(OpenEventW(EVENT_MODIFY_STATE, FALSE, name.c_str()));
+  if (!event)
+    return false;
+  event.SetEvent();
+  return true;
+}
+
+bool DecodeFlightRecord(const QString &path, QString *output) {
+  QString textPath = path + ".txt";
+  std::ifstream in(path.toStdWString(), std::ios::binary);
+  std::ofstream out(textPath.toStdWString(), std::ios::trunc);
+  if (!in || !out || !FlightRecorder::Decode(in, out))
+    return false;
+  if (output) {
+    *output = textPath;
+  }
+  return true;
+}
+
+void CALLBACK OnFlightRecordRequested(PVOID, BOOLEAN) {
+  QString path = DumpFlightRecord();
+  if (path.isEmpty()) {
+    spdlog::warn("Flight recorder dump failed");
+  } else {
+    spdlog::info("Flight recorder dumped to {}", path.toStdString());
+  }
+}
+
+void InstallFlightRecordTrigger() {
+  // Auto-reset, so every request produces one dump.
+  std::wstring name =
+      GetFlightRecordEventName(GetCurrentProcessId()).toStdWString();
+  g_flightRecordEvent.reset(CreateEventW(nullptr, FALSE, FALSE, name.c_str()));
+  if (!g_flightRecordEvent)
+    return;
+  RegisterWaitForSingleObject(
+      &g_flightRecordWait, g_flightRecordEvent.get(), OnFlightRecordRequested,
+      nullptr, INFINITE, WT_EXECUTEDEFAULT
+  );
+}
+
 spdlog::level::level_enum ParseLogLevel(
     const QString &level,
     spdlog::level::level_enum defaultLevel = spdlog::level::info
@@ -98,21 +232,79 @@ spdlog::level::level_enum ParseLogLevel(
   return defaultLevel;
 }
 
-std::shared_ptr<spdlog::logger> CreateDefaultLogger(const QString &filepath) {
+spdlog::async_overflow_policy ParseOverflowPolicy(const QString &overflow) {
+  QString lower = overflow.toLower();
+  if (lower == "drop-oldest")
+    return spdlog::async_overflow_policy::overrun_oldest;
+  if (lower == "drop-newest")
+    return spdlog::async_overflow_policy::discard_new;
+  return spdlog::async_overflow_policy::block;
+}
+
+std::shared_ptr<spdlog::logger> CreateDefaultLogger(
+    const QString &filepath, const LoggingSettings &settings = LoggingSettings()
+) {
   auto name = GetLoggerName();
   std::shared_ptr<spdlog::logger> logger;
 
-  if (!filepath.isEmpty()) {
-    logger =
-        spdlog::basic_logger_mt(name.toStdString(), filepath.toStdString());
+  spdlog::sink_ptr sink;
+  if (!filepath.isEmpty() && settings.maxSize > 0) {
+    sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(
+        filepath.toStdString(), static_cast<size_t>(settings.maxSize) << 20,
+        static_cast<size_t>(std::max(settings.maxFiles, 0))
+    );
+  } else if (!filepath.isEmpty()) {
+    sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(
+        filepath.toStdString()
+    );
   } else {
-    logger = spdlog::stderr_color_mt(name.toStdString());
+    sink = std::make_shared<spdlog::sinks::stderr_color_sink_mt>();
   }
 
+  if (settings.async) {
+    // The queue is allocated up front; a single thread keeps the order.
+    spdlog::init_thread_pool(std::max(settings.queueSize, 1), 1);
+    logger = std::make_shared<spdlog::async_logger>(
+        name.toStdString(), sink, spdlog::thread_pool(),
+        ParseOverflowPolicy(settings.overflow)
+    );
+  } else {
+    logger = std::make_shared<spdlog::logger>(name.toStdString(), sink);
+  }
+
+  // Errors are flushed by whichever thread writes them, which is the
+  // background thread in async mode.
+  logger->flush_on(spdlog::level::err);
+  spdlog::register_logger(logger);
   spdlog::set_default_logger(logger);
   return logger;
 }
 
+void DrainLogging() {
+  auto logger = spdlog::default_logger();
+  if (!logger)
+    return;
+  if (std::dynamic_pointer_cast<spdlog::async_logger>(logger)) {
+    // Bounded, since this also runs in crash handlers.
+    if (auto pool = spdlog::thread_pool()) {
+      size_t dropped = pool->overrun_counter() + pool->discard_counter();
+      if (dropped > 0) {
+        logger->warn("{} log messages dropped by a full queue", dropped);
+        pool->reset_overrun_counter();
+        pool->reset_discard_counter();
+      }
+      for (int i = 0; i < kMaxDrainWait && pool->queue_size() > 0; ++i) {
+        Sleep(1);
+      }
+    }
+  }
+  // Sinks are thread-safe, so they can be flushed from this thread even
+  // while the background thread writes.
+  for (const spdlog::sink_ptr &sink : logger->sinks()) {
+    sink->flush();
+  }
+}
+
 void SetLogLevel(spdlog::level::level_enum level) {
   return spdlog::set_level(level);
 }
@@ -219,7 +411,6 @@ void __stdcall CustomLoggingCallback(wil::FailureInfo const &failure) noexcept {
     auto logger = spdlog::default_logger();
     auto msg = QString::fromWCharArray(buf).trimmed();
     logger->error(msg.toStdString());
-    logger->flush();
   }
 }
 
@@ -231,7 +422,10 @@ LONG WINAPI CustomExceptionFilter(EXCEPTION_POINTERS *p) {
   } else {
     logger->critical("Unhandled SEH exception. (0x{:08X})", code);
   }
-  logger->flush();
+  if (!g_flightRecordPath.empty()) {
+    FlightRecorder::Dump(g_flightRecordPath);
+  }
+  DrainLogging();
   if (OriginalExceptionFilter) {
     return OriginalExceptionFilter(p);
   }
@@ -247,6 +441,10 @@ void CustomTerminateHandler() {
       LOG_CAUGHT_EXCEPTION();
     }
   }
+  if (!g_flightRecordPath.empty()) {
+    FlightRecorder::Dump(g_flightRecordPath);
+  }
+  DrainLogging();
   std::abort();
 }
 
@@ -287,6 +485,7 @@ void InstallCustomHandlers() {
   OriginalTerminateHandler = std::set_terminate(CustomTerminateHandler);
   OriginalExceptionFilter = SetUnhandledExceptionFilter(CustomExceptionFilter);
   OriginalMessageHandler = qInstallMessageHandler(CustomMessageHandler);
+  InstallFlightRecordTrigger();
 }
 
 void InitializeLoggingStandalone(const ParsedResult &parsed) {
@@ -311,8 +510,20 @@ void InitializeLoggingStandalone(const ParsedResult &parsed) {
     logLevel = ParseLogLevel(parsed.logLevel, logLevel);
   }
 
-  CreateDefaultLogger(logFile);
+  LoggingSettings settings;
+  settings.async = parsed.logAsync;
+  settings.queueSize = parsed.logQueue;
+  settings.overflow = parsed.logOverflow;
+  settings.maxSize = parsed.logMaxSize;
+  settings.maxFiles = parsed.logMaxFiles;
+  settings.retentionDays = parsed.logRetention;
+
+  CreateDefaultLogger(logFile, settings);
   SetLogLevel(logLevel);
+  if (!logFile.isEmpty() && parsed.logFile.isEmpty()) {
+    SweepLogDirectory(parsed.logDir, settings.retentionDays);
+  }
+  SetFlightRecordDirectory(parsed.logDir);
   InstallCustomHandlers();
 }
 
@@ -334,7 +545,11 @@ void InitializeLoggingSurrogate(const QString &clsid) {
     }
   }
 
-  CreateDefaultLogger(logFile);
+  CreateDefaultLogger(logFile, settings);
   SetLogLevel(logLevel);
+  if (settings.enabled) {
+    SweepLogDirectory(settings.directory, settings.retentionDays);
+  }
+  SetFlightRecordDirectory(settings.directory);
   InstallCustomHandlers();
 }
@@ -19,6 +19,8 @@
 #ifndef LOGGING_H
 #define LOGGING_H
 
+#include <windows.h>
+
 #include <QString>
 
 #include "command_line_parser.h"
@@ -28,9 +30,34 @@ struct LoggingSettings {
   QString level;
   QString directory;
   QString file;
+
+  // Log files rotate after maxSize megabytes, keeping maxFiles older
+  // files. Files in the log directory older than retentionDays are
+  // deleted at startup. Zero disables the limit.
+  int maxSize = 0;
+  int maxFiles = 3;
+  int retentionDays = 0;
+
+  // Messages are queued and written by a background thread.
+  bool async = false;
+  int queueSize = 8192;
+  QString overflow = "block";
 };
 
 void InitializeLoggingStandalone(const ParsedResult &parsed);
 void InitializeLoggingSurrogate(const QString &clsid);
 
+// Waits until queued messages are written and flushes every sink.
+void DrainLogging();
+
+// Writes the flight recorder rings next to the log files and returns the
+// path of the dump, or an empty string on failure.
+QString DumpFlightRecord();
+
+// Asks a running axhost process to dump its flight recorder.
+bool RequestFlightRecordDump(DWORD pid);
+
+// Decodes a flight recorder dump into a text file next to it.
+bool DecodeFlightRecord(const QString &path, QString *output);
+
 #endif // LOGGING_H
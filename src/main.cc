@@ -16,23 +16,33 @@
 //
 // SPDX-License-Identifier: Apache-2.0
 
+#include <sstream>
+
 #include <QApplication>
 #include <QCoreApplication>
 #include <QGuiApplication>
-#include <QMessageBox>
 #include <QScopedPointer>
+#include <QSet>
 #include <QString>
 #include <QStringList>
 
 #include "config.h"
 
+#include "class_options.h"
 #include "com_initialize_context.h"
 #include "command_line.h"
 #include "command_line_parser.h"
+#include "diagnostics.h"
+#include "idle_policy.h"
+#include "invoke_metrics.h"
 #include "logging.h"
+#include "process_pool.h"
 #include "registry_helper.h"
+#include "startup_timeline.h"
+#include "stats_page.h"
 #include "surrogate_runtime.h"
 #include "utils.h"
+#include "worker_farm.h"
 
 #include <wil/resource.h>
 #include <wil/result.h>
@@ -76,13 +86,85 @@ void InitializeComSecurity() {
   );
 }
 
+void ApplyCoalesceOptions(ParsedResult &parsed) {
+  QSet<DISPID> coalesce;
+  for (const std::string &item : parsed.coalesce) {
+    QString text = QString::fromStdString(item);
+    if (!ClassOptions::parseDispIdList(text, coalesce, ",")) {
+      QString message = QString(R"(
+Error: DISPID Parsing Failed
+
+Invalid DISPID: '%1'
+)")
+                            .arg(text)
+                            .trimmed();
+      Diagnostics::Warning(message);
+    }
+  }
+  if (!parsed.coalesceFile.isEmpty() &&
+      !ClassOptions::readDispIdFile(parsed.coalesceFile, coalesce)) {
+    QString message = QString(R"(
+Error: DISPID File Reading Failed
+
+Could not read DISPIDs from: '%1'
+)")
+                          .arg(parsed.coalesceFile)
+                          .trimmed();
+    Diagnostics::Warning(message);
+  }
+  for (ClassSpec &spec : parsed.specs) {
+    spec.options.coalesce.unite(coalesce);
+    // Only queued events can be merged.
+    if (spec.options.coalesce.isEmpty() ||
+        spec.options.events == EventMode::Async)
+      continue;
+    QString message = QString(R"(
+Warning: Coalescing Not Applied
+
+Class '%1' lists DISPIDs to coalesce without events=async.
+Only queued events can be coalesced, so its events are delivered one by one.
+)")
+                          .arg(spec.clsid_input)
+                          .trimmed();
+    Diagnostics::Warning(message);
+  }
+}
+
+void ApplyIdlePolicy(
+    HostSurrogateRuntime *runtime, const ParsedResult &parsed
+) {
+  // The parser only accepts known policy names.
+  runtime->SetIdlePolicy(IdlePolicy::create(
+      parsed.idlePolicy, parsed.timeout, parsed.idleWindow
+  ));
+}
+
+void WriteStartupTimeline(const ParsedResult &parsed) {
+  StartupTimeline::WriteToLog();
+  if (parsed.startupTimeline.isEmpty() ||
+      StartupTimeline::WriteToFile(parsed.startupTimeline))
+    return;
+  QString message = QString(R"(
+Error: Startup Timeline Writing Failed
+
+Could not write the startup timeline to: '%1'
+)")
+                        .arg(parsed.startupTimeline)
+                        .trimmed();
+  Diagnostics::Warning(message);
+}
+
 int main(int argc, char *argv[]) {
+  // Everything before this mark is spent by the loader.
+  StartupTimeline::Mark("loader");
+
   SetApplicationInformation();
 
   CommandLineParser parser;
   ParsedResult parsed;
 
   parsed = parser.tryParse(argc, argv);
+  StartupTimeline::Mark("command line");
 
   if (!parsed.classId.isNull() && parsed.embedding) {
     InitializeLoggingSurrogate(parsed.classId.toString());
@@ -91,16 +173,98 @@ int main(int argc, char *argv[]) {
   }
 
   spdlog::info("Command line: {}", CreateCommandLine(argc, argv).toStdString());
+  StartupTimeline::Mark("logging");
 
-  SetPreferredLanguages();
+  // Only affects the language of system error messages.
+  if (!parsed.fastStart) {
+    SetPreferredLanguages();
+    StartupTimeline::Mark("preferred languages");
+  }
 
   auto UninitializeCom = InitializeCom();
+  StartupTimeline::Mark("com");
   InitializeComSecurity();
+  StartupTimeline::Mark("com security");
 
   QApplication app(argc, argv);
+  QObject::connect(&app, &QCoreApplication::aboutToQuit, &DrainLogging);
   QScopedPointer<HostSurrogateRuntime> runtime;
+  StartupTimeline::Mark("application");
+
+  Diagnostics::SetInteractive(parsed.interactive);
+
+  // The second pass only adds dialogs for help, version and parse errors,
+  // which a headless host started with a valid command line never shows.
+  if (!parsed.fastStart || parsed.code != 0) {
+    // Problems found by the first pass are reported again by the second one.
+    Diagnostics::Reset();
+    parsed = parser.parse(argc, argv);
+    StartupTimeline::Mark("command line again");
+  }
+  ApplyCoalesceOptions(parsed);
+
+  if (parsed.dumpFlightRecord != 0) {
+    if (RequestFlightRecordDump(parsed.dumpFlightRecord))
+      return 0;
+    QString message = QString(R"(
+Error: Flight Recorder Dump Failed
+
+No axhost process with PID %1 is accepting dump requests.
+)")
+                          .arg(parsed.dumpFlightRecord)
+                          .trimmed();
+    WriteToConsole(message + "\n", STD_ERROR_HANDLE);
+    Diagnostics::Error(message);
+    return 1;
+  }
 
-  parsed = parser.parse(argc, argv);
+  if (parsed.stats != 0) {
+    StatsMapping mapping;
+    StatsData data;
+    if (mapping.Open(parsed.stats) && mapping.Read(data)) {
+      std::ostringstream out;
+      StatsMapping::Format(data, out);
+      WriteToConsole(QString::fromStdString(out.str()));
+      QString message = QString(R"(
+Information: Host Statistics
+
+%1
+)")
+                            .arg(QString::fromStdString(out.str()))
+                            .trimmed();
+      Diagnostics::Information(message);
+      return 0;
+    }
+    QString message = QString(R"(
+Error: Statistics Not Available
+
+No axhost process with PID %1 publishes statistics.
+)")
+                          .arg(parsed.stats)
+                          .trimmed();
+    WriteToConsole(message + "\n", STD_ERROR_HANDLE);
+    Diagnostics::Error(message);
+    return 1;
+  }
+
+  if (!parsed.decodeFlightRecord.isEmpty()) {
+    QString output;
+    if (DecodeFlightRecord(parsed.decodeFlightRecord, &output)) {
+      spdlog::info("Flight record decoded to {}", output.toStdString());
+      WriteToConsole(output + "\n");
+      return 0;
+    }
+    QString message = QString(R"(
+Error: Flight Recorder Decoding Failed
+
+Could not decode: '%1'
+)")
+                          .arg(parsed.decodeFlightRecord)
+                          .trimmed();
+    WriteToConsole(message + "\n", STD_ERROR_HANDLE);
+    Diagnostics::Error(message);
+    return 1;
+  }
 
   if (!parsed.registerAppId.isEmpty()) {
     if (!parsed.registerClassId.isEmpty()) {
@@ -113,6 +277,9 @@ int main(int argc, char *argv[]) {
     settings.enabled = parsed.registerLogging;
     settings.level = parsed.registerLogLevel;
     settings.directory = parsed.registerLogDir;
+    settings.maxSize = parsed.registerLogMaxSize;
+    settings.maxFiles = parsed.registerLogMaxFiles;
+    settings.retentionDays = parsed.registerLogRetention;
     THROW_IF_FAILED_MSG(
         WriteLoggingSettings(parsed.registerAppId, settings),
         "WriteLoggingSettings failed."
@@ -128,15 +295,84 @@ int main(int argc, char *argv[]) {
     return 0;
   }
 
+  // Children are started with the supervisor's own arguments.
+  bool isChild = !parsed.poolChild.isEmpty() || !parsed.farmWorker.isEmpty();
+
+  if (parsed.poolSize > 0 && !isChild && !parsed.specs.isEmpty()) {
+    HostProcessPool pool(
+        parsed.poolSize, QCoreApplication::arguments(), parsed.readyEvent
+    );
+    pool.Start();
+    StartupTimeline::Mark("process pool");
+    WriteStartupTimeline(parsed);
+    return app.exec();
+  }
+
+  if (parsed.workers > 0 && !isChild && !parsed.specs.isEmpty()) {
+    // The parser only accepts known balance policies.
+    FarmBalance balance = FarmBalance::Pending;
+    HostWorkerFarm::parseBalance(parsed.balance, balance);
+    // The front has to stay reachable for as long as its workers run.
+    parsed.idlePolicy = "keep-warm";
+    runtime.reset(new RunAsFarm(
+        parsed.specs, parsed.workers, balance, QCoreApplication::arguments(),
+        parsed.readyEvent
+    ));
+    StartupTimeline::Mark("registration");
+    ApplyIdlePolicy(runtime.data(), parsed);
+    WriteStartupTimeline(parsed);
+    return app.exec();
+  }
+
+  QScopedPointer<HostPoolChild> poolChild;
+  QString readyEvent = parsed.readyEvent;
+  QString activatedEvent;
+  if (!parsed.farmWorker.isEmpty()) {
+    // Each worker registers the classes under its own aliases, which only
+    // the front knows about, and serves every activation it forwards.
+    for (ClassSpec &spec : parsed.specs) {
+      spec.sanitize(REGCLS_MULTIPLEUSE);
+      spec.alias = HostWorkerFarm::WorkerAlias(spec.alias, parsed.farmWorker);
+      spec.alias_input = spec.alias.toString();
+      spec.clsctx_register = CLSCTX_LOCAL_SERVER;
+      spec.regcls = REGCLS_MULTIPLEUSE | REGCLS_MULTI_SEPARATE;
+      spec.regcls_explicit = true;
+    }
+    parsed.regcls = REGCLS_MULTIPLEUSE;
+    readyEvent = HostWorkerFarm::ReadyEventName(parsed.farmWorker);
+    parsed.idlePolicy = "keep-warm";
+    poolChild.reset(new HostPoolChild(parsed.farmWorker));
+  } else if (!parsed.poolChild.isEmpty()) {
+    readyEvent = HostProcessPool::ReadyEventName(parsed.poolChild);
+    activatedEvent = HostProcessPool::ActivatedEventName(parsed.poolChild);
+    // Waiting for a client is what a pool child is for.
+    parsed.idlePolicy = "keep-warm";
+    poolChild.reset(new HostPoolChild(parsed.poolChild));
+  }
+
   if (!parsed.classId.isNull() && parsed.embedding) {
     runtime.reset(new RunAsSurrogate(parsed.classId, parsed.embedding));
   } else if (!parsed.specs.isEmpty()) {
-    runtime.reset(
-        new RunAsStandalone(parsed.specs, parsed.readyEvent, parsed.regcls)
-    );
+    runtime.reset(new RunAsStandalone(
+        parsed.specs, readyEvent, parsed.regcls, activatedEvent
+    ));
   } else {
     return 0;
   }
+  StartupTimeline::Mark("registration");
+
+  for (const ClassSpec &spec : parsed.specs) {
+    if (spec.options.profile) {
+      InvokeMetrics::StartReporting(
+          parsed.profileInterval, parsed.profileFile
+      );
+      break;
+    }
+  }
+
+  ApplyIdlePolicy(runtime.data(), parsed);
+  runtime->GetLibraryScheduler()->SetIdleStretch(parsed.unloadIdle);
+  WriteStartupTimeline(parsed);
 
   return app.exec();
 }
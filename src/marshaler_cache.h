@@ -0,0 +1,80 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef MARSHALER_CACHE_H
+#define MARSHALER_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+
+// Marshalers created and handed out again by the caches of all objects.
+struct MarshalerCacheCounts {
+  std::atomic<uint64_t> created{0};
+  std::atomic<uint64_t> reused{0};
+};
+
+// Marshalers of one object, by interface, destination context and marshal
+// flags. The calls that marshal an interface all ask for the same one, so
+// only the first of them creates it.
+template <typename Key, typename Marshaler> class MarshalerCache {
+private:
+  MarshalerCacheCounts *m_counts;
+  std::mutex m_mutex;
+  std::map<Key, Marshaler> m_marshalers;
+
+public:
+  explicit MarshalerCache(MarshalerCacheCounts *counts) : m_counts(counts) {}
+
+  MarshalerCache(const MarshalerCache &) = delete;
+  MarshalerCache &operator=(const MarshalerCache &) = delete;
+
+  // Calls create on a miss. An empty marshaler is a failed creation and is
+  // not cached.
+  template <typename Create> Marshaler Find(const Key &key, Create create) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto search = m_marshalers.find(key);
+    if (search != m_marshalers.end()) {
+      ++m_counts->reused;
+      return search->second;
+    }
+    Marshaler marshaler = create();
+    if (marshaler) {
+      ++m_counts->created;
+      m_marshalers.emplace(key, marshaler);
+    }
+    return marshaler;
+  }
+
+  // The marshalers are released outside the lock, since the last one may
+  // release the object that owns the cache.
+  void Clear() {
+    std::map<Key, Marshaler> marshalers;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    marshalers.swap(m_marshalers);
+  }
+
+  std::size_t Size() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_marshalers.size();
+  }
+};
+
+#endif // MARSHALER_CACHE_H
@@ -0,0 +1,276 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "process_pool.h"
+
+#include <string>
+
+#include <QCoreApplication>
+
+#include "spdlog/spdlog.h"
+
+#include "command_line.h"
+#include "diagnostics.h"
+#include "registry_helper.h"
+#include "utils.h"
+
+// Children that exit before they become ready are started again after a
+// delay, and the supervisor gives up once this many fail in a row.
+static constexpr int kMaxConsecutiveFailures = 5;
+static constexpr int kReplenishDelay = 1000;
+
+bool LaunchChildProcess(
+    const QString &program, const QStringList &arguments,
+    wil::unique_process_information &process
+) {
+  std::wstring commandLine =
+      CreateCommandLine(program, arguments, "").toStdWString();
+  std::wstring path = program.toStdWString();
+  STARTUPINFOW startup = {};
+  startup.cb = sizeof(startup);
+  if (!CreateProcessW(
+          path.c_str(), commandLine.data(), nullptr, nullptr, FALSE, 0,
+          nullptr, nullptr, &startup, &process
+      )) {
+    DWORD err = GetLastError();
+    QString text = QString(R"(
+Error: Child Process Launch Failed
+
+CreateProcess failed.
+
+Command line: '%1'
+
+Error message:
+%2)")
+                       .arg(QString::fromStdWString(commandLine))
+                       .arg(GetLastErrorMessage(err))
+                       .trimmed();
+    Diagnostics::Error(text);
+    return false;
+  }
+  return true;
+}
+
+// HostProcessPool implementation
+
+HostProcessPool::HostProcessPool(
+    int size, const QStringList &arguments, const QString &readyEvent,
+    QObject *parent
+)
+    : QObject(parent),
+      m_size(size),
+      m_program(GetExecutablePath()),
+      m_arguments(arguments.mid(1)),
+      m_readyEvent(readyEvent) {
+  m_replenishTimer.setSingleShot(true);
+  connect(
+      &m_replenishTimer, &QTimer::timeout, this, &HostProcessPool::Replenish
+  );
+}
+
+HostProcessPool::~HostProcessPool() {
+  // Children in use keep serving their clients; idle ones would only wait
+  // for a supervisor that is gone.
+  for (const QSharedPointer<Child> &child : m_children) {
+    if (!child->isActivated) {
+      TerminateProcess(child->process.hProcess, 0);
+    }
+  }
+  spdlog::info(
+      "Process pool stopped: {} children launched, {} activated",
+      m_launchedCount, m_activatedCount
+  );
+}
+
+void HostProcessPool::Start() {
+  spdlog::info("Process pool started with {} children", m_size);
+  Replenish();
+}
+
+int HostProcessPool::GetAvailableCount() const {
+  int count = 0;
+  for (const QSharedPointer<Child> &child : m_children) {
+    if (!child->isActivated) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+bool HostProcessPool::Launch() {
+  QSharedPointer<Child> child = QSharedPointer<Child>::create();
+  child->id = QString("%1_%2").arg(GetCurrentProcessId()).arg(m_nextChild++);
+
+  // Both events are created before the child starts, so neither signal can
+  // be missed.
+  std::wstring readyName = ReadyEventName(child->id).toStdWString();
+  std::wstring activatedName = ActivatedEventName(child->id).toStdWString();
+  child->ready.reset(CreateEventW(nullptr, TRUE, FALSE, readyName.c_str()));
+  child->activated.reset(
+      CreateEventW(nullptr, TRUE, FALSE, activatedName.c_str())
+  );
+  if (!child->ready || !child->activated)
+    return false;
+
+  QStringList arguments = m_arguments;
+  arguments << "--pool-child" << child->id;
+  if (!LaunchChildProcess(m_program, arguments, child->process))
+    return false;
+  ++m_launchedCount;
+
+  QString id = child->id;
+  QWinEventNotifier *readyNotifier = new QWinEventNotifier(child->ready.get());
+  QWinEventNotifier *activatedNotifier =
+      new QWinEventNotifier(child->activated.get());
+  QWinEventNotifier *exitNotifier =
+      new QWinEventNotifier(child->process.hProcess);
+  connect(readyNotifier, &QWinEventNotifier::activated, this, [this, id] {
+    OnReady(id);
+  });
+  connect(activatedNotifier, &QWinEventNotifier::activated, this, [this, id] {
+    OnActivated(id);
+  });
+  connect(exitNotifier, &QWinEventNotifier::activated, this, [this, id] {
+    OnExited(id);
+  });
+  child->readyNotifier.reset(readyNotifier);
+  child->activatedNotifier.reset(activatedNotifier);
+  child->exitNotifier.reset(exitNotifier);
+  m_children.insert(id, child);
+  spdlog::debug(
+      "Pool child {} launched (pid {})", id.toStdString(),
+      child->process.dwProcessId
+  );
+  return true;
+}
+
+void HostProcessPool::Replenish() {
+  while (GetAvailableCount() < m_size) {
+    if (!Launch()) {
+      ++m_failureCount;
+      break;
+    }
+  }
+  if (m_failureCount >= kMaxConsecutiveFailures) {
+    QString text = QString(R"(
+Error: Pool Children Failing
+
+%1 pool children in a row failed to start. Exiting.
+)")
+                       .arg(m_failureCount)
+                       .trimmed();
+    Diagnostics::Error(text);
+    ExitApplicationLater(1);
+    return;
+  }
+  if (GetAvailableCount() < m_size && !m_replenishTimer.isActive()) {
+    m_replenishTimer.start(kReplenishDelay);
+  }
+}
+
+void HostProcessPool::OnReady(const QString &id) {
+  QSharedPointer<Child> child = m_children.value(id);
+  if (!child || child->isReady)
+    return;
+  child->isReady = true;
+  child->readyNotifier->setEnabled(false);
+  m_failureCount = 0;
+  if (m_readySignaled)
+    return;
+  for (const QSharedPointer<Child> &other : m_children) {
+    if (!other->isReady)
+      return;
+  }
+  // The supervisor is ready once its first set of children is.
+  m_readySignaled = true;
+  m_readyEvent.SetEvent();
+}
+
+void HostProcessPool::OnActivated(const QString &id) {
+  QSharedPointer<Child> child = m_children.value(id);
+  if (!child || child->isActivated)
+    return;
+  child->isActivated = true;
+  child->activatedNotifier->setEnabled(false);
+  ++m_activatedCount;
+  spdlog::debug("Pool child {} activated", id.toStdString());
+  Replenish();
+}
+
+void HostProcessPool::OnExited(const QString &id) {
+  QSharedPointer<Child> child = m_children.take(id);
+  if (!child)
+    return;
+  child->exitNotifier->setEnabled(false);
+  DWORD exitCode = 0;
+  GetExitCodeProcess(child->process.hProcess, &exitCode);
+  spdlog::debug(
+      "Pool child {} exited with code {}", id.toStdString(), exitCode
+  );
+  if (child->isActivated)
+    return;
+  if (!child->isReady) {
+    // Started again after a delay, so a broken command line does not spin.
+    ++m_failureCount;
+    if (!m_replenishTimer.isActive()) {
+      m_replenishTimer.start(kReplenishDelay);
+    }
+    return;
+  }
+  Replenish();
+}
+
+QString HostProcessPool::ReadyEventName(const QString &id) {
+  return QString("Local\\AxHost_Pool_%1_Ready").arg(id);
+}
+
+QString HostProcessPool::ActivatedEventName(const QString &id) {
+  return QString("Local\\AxHost_Pool_%1_Activated").arg(id);
+}
+
+DWORD HostProcessPool::SupervisorProcessId(const QString &id) {
+  return id.section('_', 0, 0).toULong();
+}
+
+// HostPoolChild implementation
+
+HostPoolChild::HostPoolChild(const QString &id, QObject *parent)
+    : QObject(parent) {
+  std::wstring activatedName =
+      HostProcessPool::ActivatedEventName(id).toStdWString();
+  m_activated.reset(OpenEventW(SYNCHRONIZE, FALSE, activatedName.c_str()));
+  m_supervisor.reset(OpenProcess(
+      SYNCHRONIZE, FALSE, HostProcessPool::SupervisorProcessId(id)
+  ));
+  if (!m_supervisor)
+    return;
+  m_supervisorNotifier.reset(new QWinEventNotifier(m_supervisor.get()));
+  connect(
+      m_supervisorNotifier.data(), &QWinEventNotifier::activated, this,
+      [this] {
+        m_supervisorNotifier->setEnabled(false);
+        bool activated = m_activated &&
+                         WaitForSingleObject(m_activated.get(), 0) ==
+                             WAIT_OBJECT_0;
+        if (!activated) {
+          spdlog::info("Pool supervisor exited before activation");
+          ExitApplicationLater();
+        }
+      }
+  );
+}
@@ -0,0 +1,112 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef PROCESS_POOL_H
+#define PROCESS_POOL_H
+
+#include <windows.h>
+
+#include <wil/resource.h>
+
+#include <QHash>
+#include <QObject>
+#include <QScopedPointer>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <QWinEventNotifier>
+
+#include "ready_event.h"
+
+// Starts another axhost process with the given arguments.
+bool LaunchChildProcess(
+    const QString &program, const QStringList &arguments,
+    wil::unique_process_information &process
+);
+
+// Supervisor that keeps a number of standalone children started with the
+// same command line ready to be activated. Each child registers its
+// classes for single use; once a client has activated one, another child
+// is started in its place.
+class HostProcessPool : public QObject {
+  Q_OBJECT
+
+private:
+  struct Child {
+    QString id;
+    wil::unique_process_information process;
+    wil::unique_event ready;
+    wil::unique_event activated;
+    QScopedPointer<QWinEventNotifier> readyNotifier;
+    QScopedPointer<QWinEventNotifier> activatedNotifier;
+    QScopedPointer<QWinEventNotifier> exitNotifier;
+    bool isReady = false;
+    bool isActivated = false;
+  };
+
+  int m_size;
+  QString m_program;
+  QStringList m_arguments;
+  HostReadyEvent m_readyEvent;
+  bool m_readySignaled = false;
+
+  QHash<QString, QSharedPointer<Child>> m_children;
+  int m_nextChild = 0;
+  int m_failureCount = 0;
+  QTimer m_replenishTimer;
+
+  quint64 m_launchedCount = 0;
+  quint64 m_activatedCount = 0;
+
+  int GetAvailableCount() const;
+  bool Launch();
+  void Replenish();
+  void OnReady(const QString &id);
+  void OnActivated(const QString &id);
+  void OnExited(const QString &id);
+
+public:
+  HostProcessPool(
+      int size, const QStringList &arguments, const QString &readyEvent,
+      QObject *parent = nullptr
+  );
+  ~HostProcessPool();
+
+  void Start();
+
+  static QString ReadyEventName(const QString &id);
+  static QString ActivatedEventName(const QString &id);
+  static DWORD SupervisorProcessId(const QString &id);
+};
+
+// Child side of a process pool or worker farm. Ends the child when the
+// supervisor goes away before a client has activated it.
+class HostPoolChild : public QObject {
+  Q_OBJECT
+
+private:
+  wil::unique_process_handle m_supervisor;
+  wil::unique_event m_activated;
+  QScopedPointer<QWinEventNotifier> m_supervisorNotifier;
+
+public:
+  HostPoolChild(const QString &id, QObject *parent = nullptr);
+};
+
+#endif // PROCESS_POOL_H
@@ -18,10 +18,7 @@
 
 #include "provide_class_info.h"
 
-#include <wil/registry.h>
-#include <wil/resource.h>
-
-#include <string>
+#include "type_info_cache.h"
 
 HostProvideClassInfo::HostProvideClassInfo(
     REFCLSID classId, IProvideClassInfo *underlying,
@@ -31,149 +28,6 @@ HostProvideClassInfo::HostProvideClassInfo(
       m_underlying(underlying),
       m_underlying2(underlying2) {}
 
-HRESULT
-HostProvideClassInfo::ReadTypeLibIdFromCLSID(REFCLSID rclsid, GUID *pLibid) {
-  if (!pLibid)
-    return E_POINTER;
-
-  wil::unique_cotaskmem_string clsidStr;
-  HRESULT hr = StringFromCLSID(rclsid, &clsidStr);
-  if (FAILED(hr))
-    return hr;
-
-  std::wstring key = L"CLSID\\";
-  key += clsidStr.get();
-  key += L"\\TypeLib";
-
-  wil::unique_hkey hKey;
-  hr = wil::reg::open_unique_key_nothrow(
-      HKEY_CLASSES_ROOT, key.c_str(), hKey, wil::reg::key_access::read
-  );
-  if (FAILED(hr))
-    return hr;
-
-  wchar_t buf[64];
-  DWORD sz = sizeof(buf);
-  LONG rc =
-      RegQueryValueExW(hKey.get(), nullptr, nullptr, nullptr, (LPBYTE)buf, &sz);
-  if (rc != ERROR_SUCCESS)
-    return HRESULT_FROM_WIN32(rc);
-
-  return CLSIDFromString(buf, pLibid);
-}
-
-HRESULT
-HostProvideClassInfo::FindLatestTypeLibVersion(
-    REFGUID libid, USHORT *pMajor, USHORT *pMinor
-) {
-  if (!pMajor || !pMinor)
-    return E_POINTER;
-  *pMajor = *pMinor = 0;
-
-  wil::unique_cotaskmem_string libStr;
-  HRESULT hr = StringFromCLSID(libid, &libStr);
-  if (FAILED(hr))
-    return hr;
-
-  std::wstring key = L"TypeLib\\";
-  key += libStr.get();
-
-  wil::unique_hkey hKey;
-  hr = wil::reg::open_unique_key_nothrow(
-      HKEY_CLASSES_ROOT, key.c_str(), hKey, wil::reg::key_access::read
-  );
-  if (FAILED(hr))
-    return TYPE_E_LIBNOTREGISTERED;
-
-  DWORD index = 0;
-  wchar_t name[64];
-  DWORD namelen = _countof(name);
-  LONG rc;
-  while ((rc = RegEnumKeyExW(
-              hKey.get(), index++, name, &namelen, nullptr, nullptr, nullptr,
-              nullptr
-          )) == ERROR_SUCCESS) {
-    unsigned x = 0, y = 0;
-    if (swscanf_s(name, L"%u.%u", &x, &y) == 2) {
-      if (x > *pMajor || (x == *pMajor && y > *pMinor)) {
-        *pMajor = (USHORT)x;
-        *pMinor = (USHORT)y;
-      }
-    }
-    namelen = _countof(name);
-  }
-
-  return (*pMajor || *pMinor) ? S_OK : TYPE_E_LIBNOTREGISTERED;
-}
-
-HRESULT
-HostProvideClassInfo::GetTypeLibFromCLSID(REFCLSID rclsid, ITypeLib **ppTL) {
-  if (!ppTL)
-    return E_POINTER;
-  *ppTL = nullptr;
-
-  GUID libid{};
-  USHORT maj = 0, min = 0;
-
-  HRESULT hr = ReadTypeLibIdFromCLSID(rclsid, &libid);
-  if (FAILED(hr))
-    return hr;
-
-  hr = FindLatestTypeLibVersion(libid, &maj, &min);
-  if (FAILED(hr))
-    return hr;
-
-  return LoadRegTypeLib(libid, maj, min, LOCALE_USER_DEFAULT, ppTL);
-}
-
-HRESULT
-HostProvideClassInfo::FindDefaultSourceIID(ITypeInfo *pCoClassTI, GUID *pOut) {
-  if (!pCoClassTI || !pOut)
-    return E_POINTER;
-
-  *pOut = GUID_NULL;
-
-  for (UINT i = 0;; ++i) {
-    INT implFlags = 0;
-    HRESULT hr = pCoClassTI->GetImplTypeFlags(i, &implFlags);
-
-    if (FAILED(hr))
-      break;
-
-    const bool isDefault = !!(implFlags & IMPLTYPEFLAG_FDEFAULT);
-    const bool isSource = !!(implFlags & IMPLTYPEFLAG_FSOURCE);
-
-    if (!isDefault)
-      continue;
-    if (!isSource)
-      continue;
-
-    HREFTYPE href = 0;
-    hr = pCoClassTI->GetRefTypeOfImplType(i, &href);
-    if (FAILED(hr))
-      continue;
-
-    ITypeInfo *pTI;
-    hr = pCoClassTI->GetRefTypeInfo(href, &pTI);
-    if (FAILED(hr) || !pTI)
-      continue;
-
-    TYPEATTR *pTA = nullptr;
-    hr = pTI->GetTypeAttr(&pTA);
-    if (FAILED(hr) || !pTA) {
-      pTI->Release();
-      continue;
-    }
-
-    *pOut = pTA->guid;
-    pTI->ReleaseTypeAttr(pTA);
-    pTI->Release();
-    return S_OK;
-  }
-
-  return TYPE_E_ELEMENTNOTFOUND;
-}
-
 ULONG STDMETHODCALLTYPE HostProvideClassInfo::AddRef() { return ++m_ref; }
 
 ULONG STDMETHODCALLTYPE HostProvideClassInfo::Release() {
@@ -209,13 +63,12 @@ HRESULT STDMETHODCALLTYPE HostProvideClassInfo::GetClassInfo(ITypeInfo **ppTI) {
   }
   if (!ppTI)
     return E_POINTER;
-  CComPtr<ITypeLib> pTL;
-  HRESULT hr = GetTypeLibFromCLSID(m_classId, &pTL);
-  if (FAILED(hr))
-    return hr;
-  if (!pTL)
-    return E_UNEXPECTED;
-  return pTL->GetTypeInfoOfGuid(m_classId, ppTI);
+  *ppTI = nullptr;
+  QSharedPointer<const HostTypeInfo> info =
+      HostTypeInfoCache::Lookup(m_classId);
+  if (FAILED(info->result))
+    return info->result;
+  return info->classInfo.CopyTo(ppTI);
 }
 
 HRESULT STDMETHODCALLTYPE
@@ -229,11 +82,16 @@ HostProvideClassInfo::GetGUID(DWORD dwGuidKind, GUID *pGUID) {
     return E_POINTER;
   if (dwGuidKind != GUIDKIND_DEFAULT_SOURCE_DISP_IID)
     return E_INVALIDARG;
-  CComPtr<ITypeInfo> pTI;
-  HRESULT hr = GetClassInfo(&pTI);
-  if (FAILED(hr))
-    return hr;
-  if (!pTI)
-    return E_UNEXPECTED;
-  return FindDefaultSourceIID(pTI, pGUID);
+  if (m_underlying) {
+    CComPtr<ITypeInfo> pTI;
+    HRESULT hr = m_underlying->GetClassInfo(&pTI);
+    if (SUCCEEDED(hr) && pTI)
+      return HostTypeInfoCache::FindDefaultSourceIID(pTI, pGUID);
+  }
+  QSharedPointer<const HostTypeInfo> info =
+      HostTypeInfoCache::Lookup(m_classId);
+  if (FAILED(info->result))
+    return info->result;
+  *pGUID = info->defaultSource;
+  return info->defaultSourceResult;
 }
@@ -32,13 +32,6 @@ private:
   CComPtr<IProvideClassInfo> m_underlying;
   CComPtr<IProvideClassInfo2> m_underlying2;
 
-private:
-  static HRESULT ReadTypeLibIdFromCLSID(REFCLSID rclsid, GUID *pLibid);
-  static HRESULT
-  FindLatestTypeLibVersion(REFGUID libid, USHORT *pMajor, USHORT *pMinor);
-  static HRESULT GetTypeLibFromCLSID(REFCLSID rclsid, ITypeLib **ppTL);
-  static HRESULT FindDefaultSourceIID(ITypeInfo *pCoClassTI, GUID *pOut);
-
 public:
   HostProvideClassInfo(
       REFCLSID classId, IProvideClassInfo *underlying,
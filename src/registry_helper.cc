@@ -18,12 +18,15 @@
 
 #include "registry_helper.h"
 
+#include <string>
+
 #include <wil/registry.h>
 #include <windows.h>
 
 #include <QCoreApplication>
 #include <QMessageBox>
 #include <QString>
+#include <QStringList>
 
 QString GetExecutablePath() {
   wchar_t path[MAX_PATH];
@@ -47,6 +50,65 @@ bool IsRunningAsAdmin() {
   return isAdmin == TRUE;
 }
 
+HRESULT ReadInprocServerPath(const QUuid &clsid, QString *path) {
+  if (!path)
+    return E_POINTER;
+
+  std::wstring key =
+      QString("CLSID\\%1\\InprocServer32").arg(clsid.toString()).toStdWString();
+
+  // REG_EXPAND_SZ values are expanded by RegGetValueW.
+  DWORD flags = RRF_RT_REG_SZ | RRF_RT_REG_EXPAND_SZ;
+  DWORD size = 0;
+  LONG rc = RegGetValueW(
+      HKEY_CLASSES_ROOT, key.c_str(), nullptr, flags, nullptr, nullptr, &size
+  );
+  if (rc != ERROR_SUCCESS)
+    return HRESULT_FROM_WIN32(rc);
+
+  std::wstring value(size / sizeof(wchar_t), L'\0');
+  rc = RegGetValueW(
+      HKEY_CLASSES_ROOT, key.c_str(), nullptr, flags, nullptr, value.data(),
+      &size
+  );
+  if (rc != ERROR_SUCCESS)
+    return HRESULT_FROM_WIN32(rc);
+
+  *path = QString::fromWCharArray(value.c_str()).trimmed();
+  return path->isEmpty() ? REGDB_E_CLASSNOTREG : S_OK;
+}
+
+HRESULT ReadThreadingModel(const QUuid &clsid, QString *model) {
+  if (!model)
+    return E_POINTER;
+
+  std::wstring key =
+      QString("CLSID\\%1\\InprocServer32").arg(clsid.toString()).toStdWString();
+
+  wchar_t value[32] = {};
+  DWORD size = sizeof(value);
+  LONG rc = RegGetValueW(
+      HKEY_CLASSES_ROOT, key.c_str(), L"ThreadingModel", RRF_RT_REG_SZ,
+      nullptr, value, &size
+  );
+  if (rc != ERROR_SUCCESS)
+    return HRESULT_FROM_WIN32(rc);
+
+  *model = QString::fromWCharArray(value).trimmed();
+  return S_OK;
+}
+
+bool IsControlClass(const QUuid &clsid) {
+  std::wstring key =
+      QString("CLSID\\%1\\Control").arg(clsid.toString()).toStdWString();
+  HKEY hKey = nullptr;
+  LONG rc = RegOpenKeyExW(HKEY_CLASSES_ROOT, key.c_str(), 0, KEY_READ, &hKey);
+  if (rc != ERROR_SUCCESS)
+    return false;
+  RegCloseKey(hKey);
+  return true;
+}
+
 HRESULT RegisterSurrogate(const QString &clsid, const QString &appid) {
   if (!IsRunningAsAdmin()) {
     QString text = QString(R"(
@@ -274,6 +336,28 @@ Registry values removed:
   }
 }
 
+static HRESULT SetLoggingValue(
+    HKEY key, const QString &appidPath, const wchar_t *name, DWORD value
+) {
+  HRESULT hr = wil::reg::set_value_nothrow(key, name, value);
+  if (FAILED(hr)) {
+    QString text = QString(R"(
+Error: Failed to Set %1
+
+Could not set %1 value in:
+HKEY_CLASSES_ROOT\%2
+
+HRESULT: 0x%3
+)")
+                       .arg(QString::fromWCharArray(name))
+                       .arg(appidPath)
+                       .arg(QString::number(hr, 16).toUpper())
+                       .trimmed();
+    QMessageBox::critical(nullptr, QCoreApplication::applicationName(), text);
+  }
+  return hr;
+}
+
 HRESULT
 WriteLoggingSettings(const QString &appid, const LoggingSettings &settings) {
   if (!IsRunningAsAdmin()) {
@@ -382,6 +466,33 @@ HRESULT: 0x%2
       }
     }
 
+    // Write LogMaxSize and LogMaxFiles (DWORD) if rotation is specified
+    QStringList limitValues;
+    if (settings.maxSize > 0) {
+      RETURN_IF_FAILED(SetLoggingValue(
+          appidKey.get(), appidPath, L"LogMaxSize", settings.maxSize
+      ));
+      RETURN_IF_FAILED(SetLoggingValue(
+          appidKey.get(), appidPath, L"LogMaxFiles", settings.maxFiles
+      ));
+      limitValues << "LogMaxSize" << "LogMaxFiles";
+    }
+
+    // Write LogRetentionDays (DWORD) if specified
+    if (settings.retentionDays > 0) {
+      RETURN_IF_FAILED(SetLoggingValue(
+          appidKey.get(), appidPath, L"LogRetentionDays",
+          settings.retentionDays
+      ));
+      limitValues << "LogRetentionDays";
+    }
+
+    QString limitKeys;
+    for (const QString &value : limitValues) {
+      limitKeys +=
+          QString("\n- HKEY_CLASSES_ROOT\\AppID\\%1\\%2").arg(appid, value);
+    }
+
     QString text =
         QString(R"(
 Success: Surrogate Logging Configuration Applied
@@ -389,7 +500,7 @@ Success: Surrogate Logging Configuration Applied
 AppID: %1
 
 Registry keys created:
-- HKEY_CLASSES_ROOT\AppID\%1\LogEnabled %2 %3
+- HKEY_CLASSES_ROOT\AppID\%1\LogEnabled %2 %3 %4
 )")
             .arg(appid)
             .arg(
@@ -404,6 +515,7 @@ Registry keys created:
                     : QString("\n- HKEY_CLASSES_ROOT\\AppID\\%1\\LogDirectory")
                           .arg(appid)
             )
+            .arg(limitKeys)
             .trimmed();
     QMessageBox::information(
         nullptr, QCoreApplication::applicationName(), text
@@ -488,6 +600,31 @@ LoggingSettings ReadLoggingSettings(const QString &clsid) {
       settings.directory = QString::fromWCharArray(dirValue.get());
     }
 
+    // Read LogMaxSize, LogMaxFiles and LogRetentionDays (DWORD)
+    DWORD maxSizeValue = 0;
+    hr = wil::reg::get_value_nothrow(
+        appidKey.get(), L"LogMaxSize", &maxSizeValue
+    );
+    if (SUCCEEDED(hr)) {
+      settings.maxSize = static_cast<int>(maxSizeValue);
+    }
+
+    DWORD maxFilesValue = 0;
+    hr = wil::reg::get_value_nothrow(
+        appidKey.get(), L"LogMaxFiles", &maxFilesValue
+    );
+    if (SUCCEEDED(hr)) {
+      settings.maxFiles = static_cast<int>(maxFilesValue);
+    }
+
+    DWORD retentionValue = 0;
+    hr = wil::reg::get_value_nothrow(
+        appidKey.get(), L"LogRetentionDays", &retentionValue
+    );
+    if (SUCCEEDED(hr)) {
+      settings.retentionDays = static_cast<int>(retentionValue);
+    }
+
     return settings;
   } catch (...) {
     LOG_CAUGHT_EXCEPTION();
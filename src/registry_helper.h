@@ -22,6 +22,7 @@
 #include <windows.h>
 
 #include <QString>
+#include <QUuid>
 
 #include "logging.h"
 
@@ -42,6 +43,18 @@ WriteLoggingSettings(const QString &appid, const LoggingSettings &settings);
 // Reads from HKCR\AppID\{appid}\ where appid is found via CLSID\{clsid}\AppID
 LoggingSettings ReadLoggingSettings(const QString &clsid);
 
+// Read the InProc server DLL path of a class
+// Reads the default value of HKCR\CLSID\{clsid}\InprocServer32
+HRESULT ReadInprocServerPath(const QUuid &clsid, QString *path);
+
+// Read the threading model of an InProc server class
+// Reads HKCR\CLSID\{clsid}\InprocServer32\ThreadingModel
+HRESULT ReadThreadingModel(const QUuid &clsid, QString *model);
+
+// Check if a class is registered as an ActiveX control
+// Looks for the HKCR\CLSID\{clsid}\Control key
+bool IsControlClass(const QUuid &clsid);
+
 // Get the full path to the current executable
 QString GetExecutablePath();
 
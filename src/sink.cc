@@ -18,15 +18,42 @@
 
 #include "sink.h"
 
+#include <vector>
+
 #include <wil/resource.h>
 
-#include <QtConcurrent>
+#include <QElapsedTimer>
+
+#include "spdlog/spdlog.h"
 
-#include <QFuture>
+#include "event_worker.h"
+#include "flight_recorder.h"
+#include "wait_handle_pool.h"
+
+// Defined first, so that it outlives the thread contexts of the pool.
+SinkProxyCache<CComPtr<IDispatch>> HostEventSink::g_proxies;
 
 QSharedPointer<QThreadPool> HostEventSink::g_threadPool;
 CComPtr<IGlobalInterfaceTable> HostEventSink::g_git;
-QThreadStorage<QSharedPointer<ComInitializeContext>> HostEventSink::g_tls;
+QThreadStorage<QSharedPointer<HostEventSinkThreadContext>>
+    HostEventSink::g_tls;
+
+std::atomic<quint64> HostEventSink::g_serial{0};
+
+std::atomic<quint64> HostEventSink::g_invokeCount{0};
+std::atomic<quint64> HostEventSink::g_coalescedCount{0};
+std::atomic<quint64> HostEventSink::g_pendingCount{0};
+
+static constexpr quint64 kInvokeCountReportInterval = 10000;
+static std::atomic<quint64> g_gitLookupCountReported{0};
+static std::atomic<quint64> g_waitHandleCountReported{0};
+
+// HostEventSinkThreadContext implementation
+
+HostEventSinkThreadContext::HostEventSinkThreadContext()
+    : sinks(&HostEventSink::g_proxies) {}
+
+// HostEventSink implementation
 
 QSharedPointer<QThreadPool> &HostEventSink::GetThreadPool() {
   if (!g_threadPool) {
@@ -45,48 +72,96 @@ CComPtr<IGlobalInterfaceTable> &HostEventSink::GetGlobalInterfaceTable() {
   return g_git;
 }
 
-QThreadStorage<QSharedPointer<ComInitializeContext>> &
+QThreadStorage<QSharedPointer<HostEventSinkThreadContext>> &
 HostEventSink::GetThreadStorage() {
   return g_tls;
 }
 
-CComPtr<IDispatch> HostEventSink::CreateGlobalSinkInThread(DWORD cookie) {
+HostEventSinkThreadContext *HostEventSink::GetThreadContext() {
   if (!g_tls.hasLocalData()) {
-    g_tls.setLocalData(
-        QSharedPointer<ComInitializeContext>::create(COINIT_MULTITHREADED)
-    );
+    g_tls.setLocalData(QSharedPointer<HostEventSinkThreadContext>::create());
   }
-  CComPtr<IDispatch> sink;
-  HRESULT hr = GetGlobalInterfaceTable()->GetInterfaceFromGlobal(
-      cookie, IID_IDispatch, (void **)&sink
+  return g_tls.localData().data();
+}
+
+void HostEventSink::ReleaseCachedSinks(DWORD cookie) {
+  auto revoked = QSharedPointer<std::vector<CComPtr<IDispatch>>>::create(
+      g_proxies.Revoke(cookie)
   );
-  return sink;
+  if (revoked->empty())
+    return;
+  // The proxies belong to the MTA, so they are released on a pool thread
+  // rather than on the caller's, which is usually the control's STA.
+  GetThreadPool()->start([revoked]() {
+    GetThreadContext();
+    revoked->clear();
+  });
 }
 
-HRESULT HostEventSink::InvokeInThread(
-    DISPID dispIdMember, REFIID riid, LCID lcid, WORD wFlags,
-    DISPPARAMS *pDispParams, VARIANT *pVarResult, EXCEPINFO *pExcepInfo,
-    UINT *puArgErr, DWORD cookie, HANDLE hEvent
+HRESULT HostEventSink::GetGlobalSinkInThread(
+    DWORD cookie, quint64 serial, IDispatch **ppSink
 ) {
-  if (!g_tls.hasLocalData()) {
-    g_tls.setLocalData(
-        QSharedPointer<ComInitializeContext>::create(COINIT_MULTITHREADED)
-    );
-  }
-  CComPtr<IGlobalInterfaceTable> &git = GetGlobalInterfaceTable();
-  CComPtr<IDispatch> sink;
-  HRESULT hr =
-      git->GetInterfaceFromGlobal(cookie, IID_IDispatch, (void **)&sink);
+  if (!ppSink)
+    return E_POINTER;
+  *ppSink = nullptr;
+  HostEventSinkThreadContext *context = GetThreadContext();
+  HRESULT hr = S_OK;
+  CComPtr<IDispatch> sink = g_proxies.Find(context->sinks, cookie, serial, [&] {
+    CComPtr<IDispatch> resolved;
+    CComPtr<IGlobalInterfaceTable> &git = GetGlobalInterfaceTable();
+    if (!git) {
+      hr = E_UNEXPECTED;
+      return resolved;
+    }
+    hr = git->GetInterfaceFromGlobal(cookie, IID_IDispatch, (void **)&resolved);
+    return resolved;
+  });
   if (FAILED(hr))
     return hr;
   if (!sink)
     return E_UNEXPECTED;
-  hr = sink->Invoke(
-      dispIdMember, riid, lcid, wFlags, pDispParams, pVarResult, pExcepInfo,
-      puArgErr
+  *ppSink = sink.Detach();
+  return S_OK;
+}
+
+void HostEventSink::CountInvoke() {
+  quint64 n = ++g_invokeCount;
+  if (n % kInvokeCountReportInterval == 0) {
+    quint64 lookups = g_proxies.GetLookupCount();
+    quint64 reported = g_gitLookupCountReported.exchange(lookups);
+    quint64 created = HostWaitHandlePool::GetCreatedCount();
+    quint64 createdReported = g_waitHandleCountReported.exchange(created);
+    spdlog::debug(
+        "Event sink: {} GIT lookups, {} wait handles created in the last {} "
+        "events",
+        lookups - reported, created - createdReported,
+        kInvokeCountReportInterval
+    );
+  }
+}
+
+void HostEventSink::DeliverInThread(HostEventCall *call) {
+  if (!call->BeginDelivery())
+    return;
+  CountInvoke();
+  CComPtr<IDispatch> sink;
+  QElapsedTimer timer;
+  timer.start();
+  HRESULT hr = GetGlobalSinkInThread(call->cookie, call->serial, &sink);
+  if (SUCCEEDED(hr)) {
+    hr = sink->Invoke(
+        call->dispIdMember, call->riid, call->lcid, call->wFlags,
+        call->pDispParams, call->pVarResult, call->pExcepInfo, call->puArgErr
+    );
+  }
+  FlightRecorder::Record(
+      FlightEvent::EventDelivery, static_cast<uint32_t>(call->dispIdMember),
+      timer.nsecsElapsed()
   );
-  SetEvent(hEvent);
-  return hr;
+  call->result = hr;
+  if (call->completed) {
+    SetEvent(call->completed);
+  }
 }
 
 HRESULT
@@ -102,11 +177,19 @@ HostEventSink::CreateGlobalSink(IUnknown *pUnkSink) {
   CComPtr<IGlobalInterfaceTable> &git = GetGlobalInterfaceTable();
   if (!git)
     return E_UNEXPECTED;
-  return git->RegisterInterfaceInGlobal(sink, IID_IDispatch, &m_cookie);
+  hr = git->RegisterInterfaceInGlobal(sink, IID_IDispatch, &m_cookie);
+  if (FAILED(hr))
+    return hr;
+  m_serial = ++g_serial;
+  g_proxies.Register(m_cookie, m_serial);
+  return hr;
 }
 
 HRESULT HostEventSink::RemoveGlobalSink() {
   if (m_cookie) {
+    // Proxies cached by the worker threads are dropped right away, so the
+    // client's sink is not kept alive after Unadvise.
+    ReleaseCachedSinks(m_cookie);
     CComPtr<IGlobalInterfaceTable> &git = GetGlobalInterfaceTable();
     if (!git)
       return E_UNEXPECTED;
@@ -117,13 +200,46 @@ HRESULT HostEventSink::RemoveGlobalSink() {
   return S_OK;
 }
 
-HostEventSink::HostEventSink(IUnknown *underlying)
+HostEventSink::HostEventSink(
+    IUnknown *underlying, const ClassOptions &options
+)
     : m_underlying(underlying) {
   m_underlyingDispatch = m_underlying;
   HRESULT hr = CreateGlobalSink(m_underlying);
+  m_ordered = options.delivery == EventDelivery::Ordered;
+  m_async = options.events == EventMode::Async;
+  m_coalesce = options.coalesce;
+  if (SUCCEEDED(hr) && (m_ordered || m_async)) {
+    QThreadPool *pool = m_ordered ? nullptr : GetThreadPool().data();
+    m_worker = QSharedPointer<HostEventWorker>::create(
+        options.queueCapacity, options.overflow, pool
+    );
+    m_worker->Start();
+  }
 }
 
-HostEventSink::~HostEventSink() { HRESULT hr = RemoveGlobalSink(); }
+HostEventSink::~HostEventSink() {
+  if (m_worker) {
+    m_worker->Stop();
+    spdlog::debug(
+        "Event sink {}: {} events queued, {} coalesced, {} dropped", m_cookie,
+        m_worker->GetPostedCount(), m_coalescedCount,
+        m_worker->GetDroppedCount()
+    );
+    m_worker.reset();
+  }
+  HRESULT hr = RemoveGlobalSink();
+}
+
+quint64 HostEventSink::GetInvokeCount() { return g_invokeCount; }
+
+quint64 HostEventSink::GetGlobalInterfaceTableLookupCount() {
+  return g_proxies.GetLookupCount();
+}
+
+quint64 HostEventSink::GetCoalescedCount() { return g_coalescedCount; }
+
+quint64 HostEventSink::GetPendingCount() { return g_pendingCount; }
 
 HRESULT STDMETHODCALLTYPE HostEventSink::GetTypeInfoCount(UINT *pctinfo) {
   if (pctinfo)
@@ -138,6 +254,33 @@ HostEventSink::GetIDsOfNames(REFIID, LPOLESTR *, UINT, LCID, DISPID *) {
   return E_NOTIMPL;
 }
 
+HRESULT HostEventSink::InvokeAsync(
+    DISPID dispIdMember, REFIID riid, LCID lcid, WORD wFlags,
+    DISPPARAMS *pDispParams
+) {
+  CComPtr<HostEventCall> call = HostEventCall::Create();
+  if (!call)
+    return E_OUTOFMEMORY;
+  call->dispIdMember = dispIdMember;
+  call->riid = riid;
+  call->lcid = lcid;
+  call->wFlags = wFlags;
+  call->cookie = m_cookie;
+  call->serial = m_serial;
+  HRESULT hr = call->CopyParams(pDispParams);
+  if (FAILED(hr))
+    return hr;
+  if (!m_coalesce.contains(dispIdMember))
+    return m_worker->PostAsync(call);
+  hr = m_worker->PostCoalesced(call);
+  if (hr == S_FALSE) {
+    ++m_coalescedCount;
+    ++g_coalescedCount;
+    return S_OK;
+  }
+  return hr;
+}
+
 HRESULT STDMETHODCALLTYPE HostEventSink::Invoke(
     DISPID dispIdMember, REFIID riid, LCID lcid, WORD wFlags,
     DISPPARAMS *pDispParams, VARIANT *pVarResult, EXCEPINFO *pExcepInfo,
@@ -147,15 +290,46 @@ HRESULT STDMETHODCALLTYPE HostEventSink::Invoke(
     return DISP_E_UNKNOWNINTERFACE;
   if (!m_cookie)
     return E_UNEXPECTED;
-  wil::unique_event hEvent;
-  hEvent.create(wil::EventOptions::None);
-  if (!hEvent)
+  if (m_async && !pVarResult && HostEventCall::CanCopyParams(pDispParams)) {
+    return InvokeAsync(dispIdMember, riid, lcid, wFlags, pDispParams);
+  }
+  CComPtr<HostEventCall> call = HostEventCall::Create();
+  if (!call)
+    return E_OUTOFMEMORY;
+  call->dispIdMember = dispIdMember;
+  call->riid = riid;
+  call->lcid = lcid;
+  call->wFlags = wFlags;
+  call->pDispParams = pDispParams;
+  call->pVarResult = pVarResult;
+  call->pExcepInfo = pExcepInfo;
+  call->puArgErr = puArgErr;
+  call->cookie = m_cookie;
+  call->serial = m_serial;
+  call->completed = HostWaitHandlePool::Acquire();
+  if (!call->completed)
     return E_FAIL;
-  HANDLE hEventRaw = hEvent.get();
-  QFuture<HRESULT> res = QtConcurrent::run(
-      GetThreadPool().data(), InvokeInThread, dispIdMember, riid, lcid, wFlags,
-      pDispParams, pVarResult, pExcepInfo, puArgErr, m_cookie, hEventRaw
-  );
+  // A nested event fired while an ordered delivery is still in progress is
+  // sent through the shared pool, since the worker that would receive it may
+  // be the one waiting on the client that caused the nesting.
+  bool ordered = m_ordered && m_worker && m_invokeDepth == 0;
+  if (ordered) {
+    HRESULT hr = m_worker->Post(call);
+    if (FAILED(hr)) {
+      HostWaitHandlePool::Release(call->completed);
+      call->completed = nullptr;
+      return hr;
+    }
+  } else {
+    GetThreadPool()->start([call]() { DeliverInThread(call); });
+  }
+  ++m_invokeDepth;
+  ++g_pendingCount;
+  auto decrementInvokeDepth = wil::scope_exit([&] {
+    --m_invokeDepth;
+    --g_pendingCount;
+  });
+  HANDLE hEventRaw = call->completed;
   DWORD index = 0;
   HRESULT hr;
   while (true) {
@@ -164,11 +338,14 @@ HRESULT STDMETHODCALLTYPE HostEventSink::Invoke(
         &index
     );
     if (FAILED(hr)) {
+      // The worker may still signal the handle, so it cannot go back to the
+      // pool. The call closes it once the worker is done with it.
+      call->AbandonCompleted();
       return hr;
     }
     if (index == WAIT_OBJECT_0)
       break;
   }
-  hr = res.result();
-  return hr;
+  HostWaitHandlePool::Release(hEventRaw);
+  return call->result;
 }
@@ -19,37 +19,76 @@
 #ifndef SINK_H
 #define SINK_H
 
+#include <atomic>
+
 #include <atlcomcli.h>
 
+#include <QSet>
 #include <QSharedPointer>
 #include <QThreadPool>
 #include <QThreadStorage>
 
+#include "class_options.h"
 #include "com_initialize_context.h"
+#include "event_call.h"
+#include "sink_proxy_cache.h"
 #include "unknown_impl.h"
 
+class HostEventWorker;
+
+// Per worker thread state. The proxy cache is declared after the COM context
+// so that the proxies are released before the thread leaves the MTA.
+struct HostEventSinkThreadContext {
+  ComInitializeContext com{COINIT_MULTITHREADED};
+  SinkProxyCache<CComPtr<IDispatch>>::ThreadCache sinks;
+
+  HostEventSinkThreadContext();
+};
+
 class HostEventSink : public CUnknownImpl<IDispatch> {
+  friend struct HostEventSinkThreadContext;
+
 private:
   CComPtr<IUnknown> m_underlying;
   CComQIPtr<IDispatch> m_underlyingDispatch;
   CComPtr<IDispatch> m_underlyingGlobalDispatch;
   DWORD m_cookie;
+  quint64 m_serial = 0;
+
+  QSharedPointer<HostEventWorker> m_worker;
+  bool m_ordered = false;
+  bool m_async = false;
+  int m_invokeDepth = 0;
+
+  QSet<DISPID> m_coalesce;
+  quint64 m_coalescedCount = 0;
 
 private:
   static QSharedPointer<QThreadPool> g_threadPool;
   static CComPtr<IGlobalInterfaceTable> g_git;
-  static QThreadStorage<QSharedPointer<ComInitializeContext>> g_tls;
+  static QThreadStorage<QSharedPointer<HostEventSinkThreadContext>> g_tls;
+
+  static SinkProxyCache<CComPtr<IDispatch>> g_proxies;
+  static std::atomic<quint64> g_serial;
+
+  static std::atomic<quint64> g_invokeCount;
+  static std::atomic<quint64> g_coalescedCount;
+  static std::atomic<quint64> g_pendingCount;
 
   static QSharedPointer<QThreadPool> &GetThreadPool();
   static CComPtr<IGlobalInterfaceTable> &GetGlobalInterfaceTable();
-  static QThreadStorage<QSharedPointer<ComInitializeContext>> &
+  static QThreadStorage<QSharedPointer<HostEventSinkThreadContext>> &
   GetThreadStorage();
+  static HostEventSinkThreadContext *GetThreadContext();
+
+  static void ReleaseCachedSinks(DWORD cookie);
+  static HRESULT
+  GetGlobalSinkInThread(DWORD cookie, quint64 serial, IDispatch **ppSink);
+  static void CountInvoke();
 
-  static CComPtr<IDispatch> CreateGlobalSinkInThread(DWORD cookie);
-  static HRESULT InvokeInThread(
+  HRESULT InvokeAsync(
       DISPID dispIdMember, REFIID riid, LCID lcid, WORD wFlags,
-      DISPPARAMS *pDispParams, VARIANT *pVarResult, EXCEPINFO *pExcepInfo,
-      UINT *puArgErr, DWORD cookie, HANDLE hEvent
+      DISPPARAMS *pDispParams
   );
 
   HRESULT
@@ -57,9 +96,16 @@ private:
   HRESULT RemoveGlobalSink();
 
 public:
-  HostEventSink(IUnknown *underlying);
+  HostEventSink(IUnknown *underlying, const ClassOptions &options);
   ~HostEventSink();
 
+  static void DeliverInThread(HostEventCall *call);
+
+  static quint64 GetInvokeCount();
+  static quint64 GetGlobalInterfaceTableLookupCount();
+  static quint64 GetCoalescedCount();
+  static quint64 GetPendingCount();
+
 public:
   HRESULT STDMETHODCALLTYPE GetTypeInfoCount(UINT *pctinfo) override;
   HRESULT STDMETHODCALLTYPE GetTypeInfo(UINT, LCID, ITypeInfo **) override;
@@ -0,0 +1,126 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef SINK_PROXY_CACHE_H
+#define SINK_PROXY_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Proxies of registered sinks, cached by cookie for each delivering thread,
+// so that steady-state delivery does not resolve the sink for every event.
+// Every registration has its own serial, so a cookie reused after a sink was
+// revoked never hits a stale proxy. Revoking a sink removes its proxies from
+// the caches of all threads at once.
+template <typename Proxy> class SinkProxyCache {
+public:
+  // The proxies of one thread. Since they belong to that thread's
+  // apartment, it is destroyed on the thread as well.
+  class ThreadCache {
+    friend class SinkProxyCache;
+
+  private:
+    struct Entry {
+      uint64_t serial = 0;
+      Proxy proxy;
+    };
+
+    SinkProxyCache *m_owner;
+    // Guards the entries against a revocation from another thread.
+    std::mutex m_mutex;
+    std::unordered_map<uint32_t, Entry> m_entries;
+
+  public:
+    explicit ThreadCache(SinkProxyCache *owner) : m_owner(owner) {
+      std::lock_guard<std::mutex> lock(m_owner->m_mutex);
+      m_owner->m_threads.insert(this);
+    }
+
+    ~ThreadCache() {
+      std::lock_guard<std::mutex> lock(m_owner->m_mutex);
+      m_owner->m_threads.erase(this);
+    }
+
+    ThreadCache(const ThreadCache &) = delete;
+    ThreadCache &operator=(const ThreadCache &) = delete;
+  };
+
+private:
+  // Guards both the thread caches and the live sinks, so that a proxy
+  // resolved while its sink is revoked is never cached.
+  std::mutex m_mutex;
+  std::unordered_set<ThreadCache *> m_threads;
+  std::unordered_map<uint32_t, uint64_t> m_live;
+
+  std::atomic<uint64_t> m_lookupCount{0};
+
+public:
+  void Register(uint32_t cookie, uint64_t serial) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_live[cookie] = serial;
+  }
+
+  // Hands back the cached proxies of the sink, to be released in the
+  // apartment they belong to.
+  std::vector<Proxy> Revoke(uint32_t cookie) {
+    std::vector<Proxy> revoked;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_live.erase(cookie);
+    for (ThreadCache *cache : m_threads) {
+      std::lock_guard<std::mutex> cacheLock(cache->m_mutex);
+      auto search = cache->m_entries.find(cookie);
+      if (search != cache->m_entries.end()) {
+        revoked.push_back(std::move(search->second.proxy));
+        cache->m_entries.erase(search);
+      }
+    }
+    return revoked;
+  }
+
+  // Calls resolve on a miss, which counts as a lookup. An empty proxy is a
+  // failed lookup and is not cached.
+  template <typename Resolve>
+  Proxy
+  Find(ThreadCache &cache, uint32_t cookie, uint64_t serial, Resolve resolve) {
+    {
+      std::lock_guard<std::mutex> cacheLock(cache.m_mutex);
+      auto search = cache.m_entries.find(cookie);
+      if (search != cache.m_entries.end() && search->second.serial == serial)
+        return search->second.proxy;
+    }
+    ++m_lookupCount;
+    Proxy proxy = resolve();
+    if (!proxy)
+      return proxy;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto live = m_live.find(cookie);
+    if (live != m_live.end() && live->second == serial) {
+      std::lock_guard<std::mutex> cacheLock(cache.m_mutex);
+      cache.m_entries[cookie] = {serial, proxy};
+    }
+    return proxy;
+  }
+
+  uint64_t GetLookupCount() const { return m_lookupCount; }
+};
+
+#endif // SINK_PROXY_CACHE_H
@@ -0,0 +1,99 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "startup_timeline.h"
+
+#include <windows.h>
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QStringList>
+
+#include "spdlog/spdlog.h"
+
+QMutex StartupTimeline::g_mutex;
+QList<StartupPhase> StartupTimeline::g_phases;
+
+static qint64 FileTimeToMicroseconds(const FILETIME &time) {
+  ULARGE_INTEGER value;
+  value.LowPart = time.dwLowDateTime;
+  value.HighPart = time.dwHighDateTime;
+  return qint64(value.QuadPart / 10);
+}
+
+qint64 StartupTimeline::GetElapsed() {
+  static const qint64 created = [] {
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+      return qint64(0);
+    return FileTimeToMicroseconds(creation);
+  }();
+  FILETIME now;
+  GetSystemTimePreciseAsFileTime(&now);
+  return FileTimeToMicroseconds(now) - created;
+}
+
+void StartupTimeline::Mark(const QString &name) {
+  qint64 now = GetElapsed();
+  QMutexLocker locker(&g_mutex);
+  qint64 start = g_phases.isEmpty() ? 0 : g_phases.last().end;
+  g_phases.append({name, start, now});
+}
+
+QList<StartupPhase> StartupTimeline::GetPhases() {
+  QMutexLocker locker(&g_mutex);
+  return g_phases;
+}
+
+void StartupTimeline::WriteToLog() {
+  QStringList parts;
+  const QList<StartupPhase> phases = GetPhases();
+  for (const StartupPhase &phase : phases) {
+    parts << QString("%1 %2 ms")
+                 .arg(phase.name)
+                 .arg((phase.end - phase.start) / 1000.0, 0, 'f', 2);
+  }
+  qint64 total = phases.isEmpty() ? 0 : phases.last().end;
+  spdlog::info(
+      "Startup timeline ({:.2f} ms): {}", total / 1000.0,
+      parts.join(", ").toStdString()
+  );
+}
+
+bool StartupTimeline::WriteToFile(const QString &path) {
+  QJsonArray array;
+  const QList<StartupPhase> phases = GetPhases();
+  for (const StartupPhase &phase : phases) {
+    QJsonObject object;
+    object["name"] = phase.name;
+    object["start_us"] = phase.start;
+    object["end_us"] = phase.end;
+    object["duration_us"] = phase.end - phase.start;
+    array.append(object);
+  }
+  QJsonObject root;
+  root["pid"] = qint64(GetCurrentProcessId());
+  root["phases"] = array;
+  QFile file(path);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    return false;
+  return file.write(QJsonDocument(root).toJson()) >= 0;
+}
@@ -0,0 +1,50 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef STARTUP_TIMELINE_H
+#define STARTUP_TIMELINE_H
+
+#include <QList>
+#include <QMutex>
+#include <QString>
+
+struct StartupPhase {
+  QString name;
+  qint64 start;
+  qint64 end;
+};
+
+// Records the phases of process startup. Times are in microseconds since
+// the process was created, so the time spent by the loader before main is
+// visible as well. Each mark ends the phase begun by the previous one.
+class StartupTimeline {
+private:
+  static QMutex g_mutex;
+  static QList<StartupPhase> g_phases;
+
+  static qint64 GetElapsed();
+
+public:
+  static void Mark(const QString &name);
+  static QList<StartupPhase> GetPhases();
+
+  static void WriteToLog();
+  static bool WriteToFile(const QString &path);
+};
+
+#endif // STARTUP_TIMELINE_H
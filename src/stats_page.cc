@@ -0,0 +1,327 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "stats_page.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static constexpr uint32_t kStatsMagic = 0x54535841; // "AXST"
+static constexpr uint16_t kStatsVersion = 3;
+
+// A reader gives up after this many torn copies; the host writes about
+// once a second, so this only happens if it died while writing.
+static constexpr int kMaxReadAttempts = 1000;
+
+static constexpr size_t kStatsWords = sizeof(StatsData) / sizeof(uint64_t);
+
+static_assert(sizeof(StatsData) % sizeof(uint64_t) == 0);
+static_assert(offsetof(StatsPage, data) % sizeof(uint64_t) == 0);
+
+static uint64_t *Words(StatsData *data) {
+  return reinterpret_cast<uint64_t *>(data);
+}
+
+StatsMapping::~StatsMapping() { Close(); }
+
+std::string StatsMapping::Name(uint32_t pid, bool global) {
+#ifdef _WIN32
+  return (global ? "Global\\AxHost_Stats_" : "Local\\AxHost_Stats_") +
+         std::to_string(pid);
+#else
+  (void)global;
+  return "/axhost_stats_" + std::to_string(pid);
+#endif
+}
+
+bool StatsMapping::Create(uint32_t pid) {
+  Close();
+#ifdef _WIN32
+  // Creating a Global section needs SeCreateGlobalPrivilege, which only
+  // services and elevated processes have by default.
+  for (bool global : {true, false}) {
+    m_handle = CreateFileMappingA(
+        INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, sizeof(StatsPage),
+        Name(pid, global).c_str()
+    );
+    if (m_handle)
+      break;
+  }
+  if (!m_handle)
+    return false;
+  m_page = static_cast<StatsPage *>(
+      MapViewOfFile(m_handle, FILE_MAP_WRITE, 0, 0, sizeof(StatsPage))
+  );
+#else
+  std::string name = Name(pid);
+  int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0600);
+  if (fd < 0)
+    return false;
+  m_unlinkName = name;
+  void *view = MAP_FAILED;
+  if (ftruncate(fd, sizeof(StatsPage)) == 0) {
+    view = mmap(
+        nullptr, sizeof(StatsPage), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0
+    );
+  }
+  close(fd);
+  if (view != MAP_FAILED) {
+    m_page = static_cast<StatsPage *>(view);
+  }
+#endif
+  if (!m_page) {
+    Close();
+    return false;
+  }
+  m_writable = true;
+  std::memset(m_page, 0, sizeof(StatsPage));
+  m_page->version = kStatsVersion;
+  m_page->dataSize = sizeof(StatsData);
+  // Readers check the magic first, so it is written last.
+  std::atomic_ref<uint32_t>(m_page->magic)
+      .store(kStatsMagic, std::memory_order_release);
+  return true;
+}
+
+bool StatsMapping::Open(uint32_t pid) {
+  Close();
+#ifdef _WIN32
+  for (bool global : {true, false}) {
+    m_handle =
+        OpenFileMappingA(FILE_MAP_READ, FALSE, Name(pid, global).c_str());
+    if (m_handle)
+      break;
+  }
+  if (!m_handle)
+    return false;
+  m_page = static_cast<StatsPage *>(
+      MapViewOfFile(m_handle, FILE_MAP_READ, 0, 0, sizeof(StatsPage))
+  );
+#else
+  int fd = shm_open(Name(pid).c_str(), O_RDONLY, 0);
+  if (fd < 0)
+    return false;
+  struct stat info = {};
+  void *view = MAP_FAILED;
+  if (fstat(fd, &info) == 0 &&
+      static_cast<size_t>(info.st_size) >= sizeof(StatsPage)) {
+    view = mmap(nullptr, sizeof(StatsPage), PROT_READ, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (view != MAP_FAILED) {
+    m_page = static_cast<StatsPage *>(view);
+  }
+#endif
+  if (!m_page) {
+    Close();
+    return false;
+  }
+  return true;
+}
+
+void StatsMapping::Close() {
+#ifdef _WIN32
+  if (m_page) {
+    UnmapViewOfFile(m_page);
+  }
+  if (m_handle) {
+    CloseHandle(m_handle);
+  }
+  m_handle = nullptr;
+#else
+  if (m_page) {
+    munmap(m_page, sizeof(StatsPage));
+  }
+  if (!m_unlinkName.empty()) {
+    shm_unlink(m_unlinkName.c_str());
+    m_unlinkName.clear();
+  }
+#endif
+  m_page = nullptr;
+  m_writable = false;
+}
+
+void StatsMapping::Publish(const StatsData &data) {
+  if (!m_page || !m_writable)
+    return;
+  std::atomic_ref<uint64_t> sequence(m_page->sequence);
+  uint64_t start = sequence.load(std::memory_order_relaxed);
+  sequence.store(start + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  const uint64_t *source = reinterpret_cast<const uint64_t *>(&data);
+  uint64_t *target = Words(&m_page->data);
+  for (size_t i = 0; i < kStatsWords; ++i) {
+    std::atomic_ref<uint64_t>(target[i])
+        .store(source[i], std::memory_order_relaxed);
+  }
+  sequence.store(start + 2, std::memory_order_release);
+}
+
+bool StatsMapping::Read(StatsData &data) const {
+  if (!m_page)
+    return false;
+  uint32_t magic = std::atomic_ref<uint32_t>(m_page->magic)
+                       .load(std::memory_order_acquire);
+  if (magic != kStatsMagic || m_page->version < kStatsVersion)
+    return false;
+  // Fields appended by a newer host are ignored, missing ones read as 0.
+  size_t words = std::min<size_t>(
+      m_page->dataSize / sizeof(uint64_t), kStatsWords
+  );
+  std::atomic_ref<uint64_t> sequence(m_page->sequence);
+  uint64_t *source = Words(&m_page->data);
+  uint64_t *target = Words(&data);
+  for (int attempt = 0; attempt < kMaxReadAttempts; ++attempt) {
+    uint64_t before = sequence.load(std::memory_order_acquire);
+    if (before & 1)
+      continue;
+    std::memset(&data, 0, sizeof(StatsData));
+    for (size_t i = 0; i < words; ++i) {
+      target[i] = std::atomic_ref<uint64_t>(source[i])
+                      .load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (sequence.load(std::memory_order_relaxed) == before)
+      return true;
+  }
+  return false;
+}
+
+void StatsMapping::SetText(
+    StatsDiagnostic &diagnostic, const std::string &text
+) {
+  char *target = reinterpret_cast<char *>(diagnostic.text);
+  size_t size = std::min(text.size(), sizeof(diagnostic.text) - 1);
+  // Never cut a UTF-8 sequence in half.
+  if (size < text.size()) {
+    while (size > 0 && (static_cast<unsigned char>(text[size]) & 0xC0) == 0x80)
+      --size;
+  }
+  std::memset(target, 0, sizeof(diagnostic.text));
+  std::memcpy(target, text.data(), size);
+}
+
+std::string StatsMapping::GetText(const StatsDiagnostic &diagnostic) {
+  const char *source = reinterpret_cast<const char *>(diagnostic.text);
+  return std::string(source, strnlen(source, sizeof(diagnostic.text) - 1));
+}
+
+static std::string FormatClassId(const uint64_t classId[2]) {
+  struct {
+    uint32_t data1;
+    uint16_t data2;
+    uint16_t data3;
+    uint8_t data4[8];
+  } guid;
+  static_assert(sizeof(guid) == 2 * sizeof(uint64_t));
+  std::memcpy(&guid, classId, sizeof(guid));
+  std::ostringstream out;
+  out << std::hex << std::uppercase << std::setfill('0') << '{'
+      << std::setw(8) << guid.data1 << '-' << std::setw(4) << guid.data2
+      << '-' << std::setw(4) << guid.data3 << '-';
+  for (int i = 0; i < 8; ++i) {
+    if (i == 2) {
+      out << '-';
+    }
+    out << std::setw(2) << static_cast<unsigned>(guid.data4[i]);
+  }
+  out << '}';
+  return out.str();
+}
+
+static std::string FormatMilliseconds(uint64_t nanoseconds) {
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(2) << nanoseconds / 1e6;
+  return out.str();
+}
+
+static void FormatClasses(
+    const StatsData &data, uint64_t classCount, std::ostream &out
+) {
+  out << '\n'
+      << std::left << std::setw(40) << "Class" << std::right
+      << std::setw(12) << "Activations" << std::setw(10) << "Failures"
+      << std::setw(10) << "p50 ms" << std::setw(10) << "p99 ms"
+      << std::setw(10) << "max ms" << '\n';
+  for (uint64_t i = 0; i < classCount; ++i) {
+    const StatsClass &item = data.classes[i];
+    out << std::left << std::setw(40) << FormatClassId(item.classId)
+        << std::right << std::setw(12) << item.activations << std::setw(10)
+        << item.failures << std::setw(10) << FormatMilliseconds(item.latencyP50)
+        << std::setw(10) << FormatMilliseconds(item.latencyP99)
+        << std::setw(10) << FormatMilliseconds(item.latencyMax) << '\n';
+  }
+}
+
+void StatsMapping::Format(const StatsData &data, std::ostream &out) {
+  uint64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                     std::chrono::system_clock::now().time_since_epoch()
+  )
+                     .count();
+  uint64_t uptime =
+      data.updateTime > data.startTime ? data.updateTime - data.startTime : 0;
+  uint64_t age = now > data.updateTime ? now - data.updateTime : 0;
+
+  out << "Process:            " << data.processId << '\n'
+      << "Uptime:             " << uptime / 1000 << " s (updated " << age
+      << " ms ago)\n"
+      << "Server references:  " << data.serverReferences << '\n'
+      << "Live containers:    " << data.liveContainers << '\n'
+      << "Wrappers:           " << data.wrappers << '\n'
+      << "Pool hits:          " << data.poolHits << '\n'
+      << "Pool misses:        " << data.poolMisses << '\n'
+      << "Pool recycled:      " << data.poolRecycled << '\n'
+      << "Pending deliveries: " << data.pendingDeliveries << '\n'
+      << "Queued events:      " << data.queuedEvents << '\n'
+      << "Delivered events:   " << data.deliveredEvents << '\n'
+      << "Errors:             " << data.errors << '\n'
+      << "Warnings:           " << data.warnings << '\n';
+
+  uint64_t classCount =
+      std::min<uint64_t>(data.classCount, kStatsMaxClasses);
+  if (classCount > 0) {
+    FormatClasses(data, classCount, out);
+  }
+
+  uint64_t diagnosticCount =
+      std::min<uint64_t>(data.diagnosticCount, kStatsMaxDiagnostics);
+  if (diagnosticCount == 0)
+    return;
+  out << "\nRecent diagnostics:\n";
+  for (uint64_t i = 0; i < diagnosticCount; ++i) {
+    const StatsDiagnostic &item = data.diagnostics[i];
+    uint64_t since = now > item.time ? now - item.time : 0;
+    out << std::right << std::setw(8) << since / 1000 << " s ago  "
+        << GetText(item) << '\n';
+  }
+}
@@ -0,0 +1,124 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef STATS_PAGE_H
+#define STATS_PAGE_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+static constexpr int kStatsMaxClasses = 64;
+static constexpr int kStatsMaxDiagnostics = 16;
+static constexpr int kStatsDiagnosticWords = 32;
+
+// Per-class activation counters. Latencies are in nanoseconds.
+struct StatsClass {
+  uint64_t classId[2];
+  uint64_t activations;
+  uint64_t failures;
+  uint64_t latencyP50;
+  uint64_t latencyP99;
+  uint64_t latencyMax;
+};
+
+// A recent diagnostic report. 'time' is in milliseconds since the Unix
+// epoch, 'severity' is 0 for information, 1 for warning and 2 for error,
+// and 'text' holds the logged line as NUL-terminated, truncated UTF-8.
+struct StatsDiagnostic {
+  uint64_t time;
+  uint64_t severity;
+  uint64_t text[kStatsDiagnosticWords];
+};
+
+// Host state as of 'updateTime', in milliseconds since the Unix epoch.
+// Every field is a 64-bit word, so readers can copy it with atomic loads
+// while the host writes. New fields are only ever appended.
+struct StatsData {
+  uint64_t processId;
+  uint64_t startTime;
+  uint64_t updateTime;
+  uint64_t serverReferences;
+  uint64_t liveContainers;
+  uint64_t wrappers;
+  uint64_t pendingDeliveries;
+  uint64_t queuedEvents;
+  uint64_t deliveredEvents;
+  uint64_t errors;
+  uint64_t warnings;
+  uint64_t classCount;
+  StatsClass classes[kStatsMaxClasses];
+  uint64_t diagnosticCount;
+  StatsDiagnostic diagnostics[kStatsMaxDiagnostics];
+  uint64_t poolHits;
+  uint64_t poolMisses;
+  uint64_t poolRecycled;
+};
+
+// The shared block. 'sequence' is odd while the host is writing, so a
+// reader retries until it has copied the data between two equal, even
+// values. A host that appends fields bumps 'version'; readers accept any
+// version at least their own and copy the 'dataSize' bytes they know.
+struct StatsPage {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t reserved;
+  uint64_t dataSize;
+  uint64_t sequence;
+  StatsData data;
+};
+
+// Statistics a host publishes in a named shared memory block, which other
+// processes read without any COM call into the host. Only standard C++ and
+// the platform's shared memory are used, so the layout and the reader also
+// build on other platforms, where POSIX shared memory backs the block.
+class StatsMapping {
+private:
+  StatsPage *m_page = nullptr;
+  bool m_writable = false;
+#ifdef _WIN32
+  void *m_handle = nullptr;
+#else
+  std::string m_unlinkName;
+#endif
+
+  StatsMapping(const StatsMapping &) = delete;
+  StatsMapping &operator=(const StatsMapping &) = delete;
+
+public:
+  StatsMapping() = default;
+  ~StatsMapping();
+
+  // On Windows the block is created in the Global namespace, so tools in
+  // other sessions find it, unless the host lacks the privilege to do so.
+  static std::string Name(uint32_t pid, bool global = true);
+
+  bool Create(uint32_t pid);
+  bool Open(uint32_t pid);
+  void Close();
+
+  void Publish(const StatsData &data);
+  bool Read(StatsData &data) const;
+
+  static void SetText(StatsDiagnostic &diagnostic, const std::string &text);
+  static std::string GetText(const StatsDiagnostic &diagnostic);
+
+  static void Format(const StatsData &data, std::ostream &out);
+};
+
+#endif // STATS_PAGE_H
@@ -22,17 +22,21 @@
 #include <windows.h>
 
 #include <QCoreApplication>
-#include <QMessageBox>
+#include <QElapsedTimer>
 #include <QString>
 
+#include "spdlog/spdlog.h"
+
 #include "class_spec.h"
 #include "container_factory.h"
+#include "diagnostics.h"
+#include "library_prefetcher.h"
 #include "utils.h"
 
 HRESULT
 HostSurrogate::LoadDllServerEx(
     REFCLSID clsid, REFCLSID alias, DWORD clsctx_create, DWORD clsctx_register,
-    DWORD regcls
+    DWORD regcls, const ClassOptions &options
 ) {
   DWORD cookie = 0;
   CComPtr<IClassFactory> original;
@@ -56,10 +60,10 @@ Self-instantiation may occur. Consider using an explicit alias.
 )")
                          .arg(QUuid(clsid).toString())
                          .trimmed();
-      QMessageBox::warning(nullptr, QCoreApplication::applicationName(), text);
+      Diagnostics::Warning(text);
     }
   }
-  surrogate = new HostContainerFactory(clsid, clsctx_create);
+  surrogate = new HostContainerFactory(clsid, clsctx_create, options);
   HRESULT reg =
       CoRegisterClassObject(alias, surrogate, clsctx_register, regcls, &cookie);
   if (FAILED(reg)) {
@@ -96,10 +100,33 @@ HostSurrogate::RegisterAllClassFactories(
   }
   for (ClassSpec &spec : specs) {
     spec.sanitize(regcls);
+  }
+  QElapsedTimer total;
+  total.start();
+  // Class objects have to be created on this thread, but the DLLs behind
+  // them can be loaded concurrently beforehand.
+  HostLibraryPrefetcher prefetcher;
+  if (specs.size() > 1) {
+    prefetcher.Prefetch(specs);
+  }
+  qint64 prefetchElapsed = total.elapsed();
+  for (qsizetype i = 0; i < specs.size(); ++i) {
+    ClassSpec &spec = specs[i];
+    QElapsedTimer timer;
+    timer.start();
     spec.result = LoadDllServerEx(
         spec.clsid, spec.alias, spec.clsctx_create, spec.clsctx_register,
-        spec.regcls
+        spec.regcls, spec.options
     );
+    if (specs.size() > 1) {
+      const HostLibraryPrefetcher::Result &prefetch = prefetcher.GetResult(i);
+      spdlog::info(
+          "Class {}: prefetch {} ms (0x{:08x}), registration {} ms (0x{:08x})",
+          spec.alias.toString().toStdString(), prefetch.elapsed,
+          static_cast<unsigned long>(prefetch.result), timer.elapsed(),
+          static_cast<unsigned long>(spec.result)
+      );
+    }
     if (FAILED(spec.result)) {
       spec.error = GetLastError();
       {
@@ -118,9 +145,7 @@ Error message:
                            .arg(QString::number(spec.clsctx_register, 16))
                            .arg(msg)
                            .trimmed();
-        QMessageBox::warning(
-            nullptr, QCoreApplication::applicationName(), text
-        );
+        Diagnostics::Warning(text);
       }
       if (SUCCEEDED(hrOverall)) {
         hrOverall = spec.result;
@@ -128,6 +153,12 @@ Error message:
       continue;
     }
   }
+  if (specs.size() > 1) {
+    spdlog::info(
+        "Registered {} classes in {} ms ({} ms loading libraries in parallel)",
+        specs.size(), total.elapsed(), prefetchElapsed
+    );
+  }
   return hrOverall;
 }
 
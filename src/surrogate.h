@@ -22,6 +22,7 @@
 #include <QList>
 #include <QSet>
 
+#include "class_options.h"
 #include "class_spec.h"
 #include "unknown_impl.h"
 
@@ -34,7 +35,8 @@ public:
       REFCLSID clsid, REFCLSID alias,
       DWORD clsctx_create = CLSCTX_INPROC_SERVER,
       DWORD clsctx_register = CLSCTX_LOCAL_SERVER,
-      DWORD regcls = REGCLS_SURROGATE | REGCLS_MULTI_SEPARATE
+      DWORD regcls = REGCLS_SURROGATE | REGCLS_MULTI_SEPARATE,
+      const ClassOptions &options = ClassOptions()
   );
   HRESULT LoadDllServerEx(
       REFCLSID clsid, DWORD clsctx = CLSCTX_LOCAL_SERVER,
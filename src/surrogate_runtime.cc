@@ -18,18 +18,34 @@
 
 #include "surrogate_runtime.h"
 
-#include <QMessageBox>
+#include <cstring>
+#include <string>
 
+#include <QDateTime>
+#include <QThread>
+
+#include "spdlog/spdlog.h"
+
+#include "container.h"
+#include "container_factory.h"
+#include "container_pool.h"
+#include "diagnostics.h"
+#include "event_worker.h"
+#include "flight_recorder.h"
+#include "sink.h"
 #include "utils.h"
 
+// Milliseconds between updates of the shared statistics page.
+static constexpr int kStatsInterval = 1000;
+
 // HostSurrogateRuntime implementation
 
 HostSurrogateRuntime::HostSurrogateRuntime(QObject *parent)
     : QObject(parent),
       m_surrogate(new HostSurrogate()) {
   InitializeStaticInstance();
-  StartUnusedLibraryCleaner();
   StartExitConditionChecker();
+  StartStatsPublisher();
 }
 
 HostSurrogateRuntime::~HostSurrogateRuntime() {
@@ -49,77 +65,177 @@ A HostSurrogateRuntime instance already exists.
 Cannot create multiple instances.
 )")
                        .trimmed();
-    QMessageBox::critical(nullptr, QCoreApplication::applicationName(), text);
+    Diagnostics::Error(text);
     ExitApplicationLater();
     return;
   }
   s_instance = this;
 }
 
-void HostSurrogateRuntime::StartUnusedLibraryCleaner() {
-  QCoreApplication *app = QCoreApplication::instance();
-  if (!app) {
-    return;
-  }
-  QAbstractEventDispatcher *dispatcher = app->eventDispatcher();
-  if (!dispatcher) {
+void HostSurrogateRuntime::StartExitConditionChecker() {
+  m_idlePolicy.reset(new FixedIdlePolicy(m_checkForExitTimeout));
+  m_checkForExitTimer.setSingleShot(true);
+  connect(
+      &m_checkForExitTimer, &QTimer::timeout, this,
+      &HostSurrogateRuntime::CheckForExit
+  );
+  CheckForExitLater();
+}
+
+void HostSurrogateRuntime::StartStatsPublisher() {
+  m_startTime = QDateTime::currentMSecsSinceEpoch();
+  if (!m_stats.Create(GetCurrentProcessId())) {
+    spdlog::warn("Statistics page could not be created");
     return;
   }
   connect(
-      dispatcher, &QAbstractEventDispatcher::aboutToBlock, this,
-      &HostSurrogateRuntime::OnAboutToBlock
+      &m_statsTimer, &QTimer::timeout, this, &HostSurrogateRuntime::PublishStats
   );
+  m_statsTimer.start(kStatsInterval);
+  PublishStats();
 }
 
-void HostSurrogateRuntime::StartExitConditionChecker() {
-  m_checkForExitTimer.setSingleShot(true);
-  m_checkForExitTimer.setInterval(m_checkForExitTimeout);
-  connect(
-      &m_checkForExitTimer, &QTimer::timeout, this,
-      &HostSurrogateRuntime::CheckForExit
+void HostSurrogateRuntime::PublishStats() {
+  // Only counters are read here, so a busy or blocked apartment is never
+  // called into.
+  StatsData data = {};
+  data.processId = GetCurrentProcessId();
+  data.startTime = m_startTime;
+  data.updateTime = QDateTime::currentMSecsSinceEpoch();
+  data.serverReferences = m_serverReferenceCount;
+  data.liveContainers = HostContainer::GetLiveContainerCount();
+  data.wrappers = HostContainer::GetWrapperCount();
+  data.poolHits = HostContainerPool::GetTotalHitCount();
+  data.poolMisses = HostContainerPool::GetTotalMissCount();
+  data.poolRecycled = HostContainerPool::GetTotalRecycledCount();
+  data.pendingDeliveries = HostEventSink::GetPendingCount();
+  data.queuedEvents = HostEventWorker::GetQueuedCount();
+  data.deliveredEvents = HostEventSink::GetInvokeCount();
+  data.errors = Diagnostics::GetErrorCount();
+  data.warnings = Diagnostics::GetWarningCount();
+
+  const QList<HostActivationStats> classes =
+      HostContainerFactory::GetActivationStats();
+  for (const HostActivationStats &stats : classes) {
+    if (data.classCount == kStatsMaxClasses)
+      break;
+    StatsClass &item = data.classes[data.classCount++];
+    GUID classId = stats.classId;
+    std::memcpy(item.classId, &classId, sizeof(item.classId));
+    item.activations = stats.activations;
+    item.failures = stats.failures;
+    item.latencyP50 = InvokeHistogram::Percentile(stats.latency, 0.5);
+    item.latencyP99 = InvokeHistogram::Percentile(stats.latency, 0.99);
+    item.latencyMax = InvokeHistogram::Maximum(stats.latency);
+  }
+
+  // Only the most recent reports fit.
+  const QList<Diagnostic> diagnostics = Diagnostics::GetDiagnostics();
+  qsizetype first = qMax<qsizetype>(
+      0, diagnostics.size() - kStatsMaxDiagnostics
+  );
+  for (qsizetype i = first; i < diagnostics.size(); ++i) {
+    const Diagnostic &diagnostic = diagnostics[i];
+    StatsDiagnostic &item = data.diagnostics[data.diagnosticCount++];
+    item.time = diagnostic.time.toMSecsSinceEpoch();
+    item.severity = static_cast<uint64_t>(diagnostic.severity);
+    QString text = diagnostic.title + " " + diagnostic.message.simplified();
+    StatsMapping::SetText(item, text.toStdString());
+  }
+
+  m_stats.Publish(data);
+}
+
+void HostSurrogateRuntime::SetIdlePolicy(IdlePolicy *policy) {
+  if (!policy)
+    return;
+  m_idlePolicy.reset(policy);
+  spdlog::info(
+      "Idle policy: {} (timeout {} ms)", m_idlePolicy->name().toStdString(),
+      m_idlePolicy->timeout()
   );
-  m_checkForExitTimer.start(m_checkForExitTimeout);
+  CheckForExit();
+}
+
+HostLibraryScheduler *HostSurrogateRuntime::GetLibraryScheduler() {
+  return &m_libraryScheduler;
 }
 
 void HostSurrogateRuntime::CheckForExit() {
-  ULONG a = CoAddRefServerProcess();
-  ULONG r = CoReleaseServerProcess();
-  if (r == 0) {
-    if (m_acquisitionCount == 0 && !m_warnedIdle) {
-      m_warnedIdle = true;
-      QString text = QString(R"(
+  // Re-evaluated when the last reference is released.
+  if (m_serverReferenceCount > 0 || m_exiting)
+    return;
+  qint64 remaining = m_idlePolicy->RemainingIdleTime(m_idleTimer.elapsed());
+  if (remaining != 0 && m_classObjectsSuspended.exchange(false)) {
+    // COM suspends the class objects once the server process count drops
+    // to zero. Accept activations again while the idle policy keeps us.
+    CoResumeClassObjects();
+  }
+  if (remaining < 0) {
+    m_checkForExitTimer.stop();
+    return;
+  }
+  if (remaining > 0) {
+    m_checkForExitTimer.start(remaining);
+    return;
+  }
+  if (m_acquisitionCount == 0 && !m_warnedIdle) {
+    m_warnedIdle = true;
+    QString text = QString(R"(
 Warning: Timed Out For No Interaction
 
 No COM interaction has occurred for the timeout period (%1 ms).
 Server process will now terminate.
 )")
-                         .arg(m_checkForExitTimeout)
-                         .trimmed();
-      QMessageBox::warning(nullptr, QCoreApplication::applicationName(), text);
-    }
-    ExitApplicationLater();
-  } else {
-    CheckForExitLater();
+                       .arg(m_idlePolicy->timeout())
+                       .trimmed();
+    Diagnostics::Warning(text);
   }
+  m_exiting = true;
+  CoSuspendClassObjects();
+  ExitApplicationLater();
 }
 
 void HostSurrogateRuntime::CheckForExitLater() {
-  m_checkForExitTimer.start(m_checkForExitTimeout);
+  m_idleTimer.start();
+  CheckForExit();
 }
 
-void HostSurrogateRuntime::FreeUnusedLibraries() {
-  if (!m_freeUnusedLibrariesTimer.isValid() ||
-      m_freeUnusedLibrariesTimer.hasExpired(m_freeUnusedLibrariesInterval)) {
-    m_freeUnusedLibrariesTimer.restart();
-    ::CoFreeUnusedLibraries();
-  }
+void HostSurrogateRuntime::OnServerReferenceAdded() {
+  m_idlePolicy->OnActivation();
+  m_checkForExitTimer.stop();
 }
 
-void HostSurrogateRuntime::OnAboutToBlock() { FreeUnusedLibraries(); }
-
-void HostSurrogateRuntime::AddServerReference() {}
+void HostSurrogateRuntime::AddServerReference() {
+  ulong count = ++m_serverReferenceCount;
+  ++m_acquisitionCount;
+  FlightRecorder::Record(FlightEvent::ServerReferenceAdded, count);
+  // Containers in dedicated apartments call in from their own threads;
+  // the timers belong to this one.
+  if (QThread::currentThread() == thread()) {
+    OnServerReferenceAdded();
+  } else {
+    QMetaObject::invokeMethod(
+        this, &HostSurrogateRuntime::OnServerReferenceAdded,
+        Qt::QueuedConnection
+    );
+  }
+}
 
-void HostSurrogateRuntime::ReleaseServerReference() {}
+void HostSurrogateRuntime::ReleaseServerReference() {
+  FlightRecorder::Record(
+      FlightEvent::ServerReferenceReleased, m_serverReferenceCount.load()
+  );
+  if (m_serverReferenceCount > 0 && --m_serverReferenceCount == 0) {
+    if (QThread::currentThread() == thread()) {
+      CheckForExitLater();
+    } else {
+      QMetaObject::invokeMethod(
+          this, &HostSurrogateRuntime::CheckForExitLater, Qt::QueuedConnection
+      );
+    }
+  }
+}
 
 // RunAsSurrogate implementation
 
@@ -137,10 +253,15 @@ RunAsSurrogate::~RunAsSurrogate() {}
 
 RunAsStandalone::RunAsStandalone(
     QList<ClassSpec> &specs, const QString &readyEvent, DWORD regcls,
-    QObject *parent
+    const QString &activatedEvent, QObject *parent
 )
     : HostSurrogateRuntime(parent),
       m_readyEvent(readyEvent) {
+  if (!activatedEvent.isEmpty()) {
+    // Tells a pool supervisor that this process has been taken by a client.
+    std::wstring name = activatedEvent.toStdWString();
+    m_activatedEvent.reset(OpenEventW(EVENT_MODIFY_STATE, FALSE, name.c_str()));
+  }
   CheckMultipleUse(specs, regcls);
   {
     HRESULT sus = CoSuspendClassObjects();
@@ -155,7 +276,7 @@ Error: No Class Registered
 No class factory could be registered. Exiting.
 )")
                          .trimmed();
-      QMessageBox::critical(nullptr, QCoreApplication::applicationName(), text);
+      Diagnostics::Error(text);
       DWORD err = GetLastError();
       ExitApplicationLater();
     }
@@ -196,17 +317,72 @@ void RunAsStandalone::CheckMultipleUse(QList<ClassSpec> &specs, DWORD regcls) {
 }
 
 void RunAsStandalone::AddServerReference() {
+  if (m_activatedEvent) {
+    m_activatedEvent.SetEvent();
+  }
   CoAddRefServerProcess();
-  ++m_acquisitionCount;
+  HostSurrogateRuntime::AddServerReference();
 }
 
 void RunAsStandalone::ReleaseServerReference() {
-  bool shouldExit = CoReleaseServerProcess() == 0;
-  if (shouldExit) {
-    if (m_hasMultipleUse) {
-      CheckForExitLater();
-    } else {
-      ExitApplicationLater();
+  bool suspended = CoReleaseServerProcess() == 0;
+  if (suspended && !m_hasMultipleUse) {
+    m_exiting = true;
+    ExitApplicationLater();
+    return;
+  }
+  if (suspended) {
+    m_classObjectsSuspended = true;
+  }
+  HostSurrogateRuntime::ReleaseServerReference();
+}
+
+// RunAsFarm implementation
+
+RunAsFarm::RunAsFarm(
+    QList<ClassSpec> &specs, int workers, FarmBalance balance,
+    const QStringList &arguments, const QString &readyEvent, QObject *parent
+)
+    : HostSurrogateRuntime(parent),
+      m_farm(specs, workers, balance, arguments, readyEvent) {
+  m_hasMultipleUse = true;
+  for (qsizetype i = 0; i < specs.size(); ++i) {
+    ClassSpec &spec = specs[i];
+    spec.sanitize(REGCLS_MULTIPLEUSE);
+    // The front serves every activation; only the workers create objects.
+    CComPtr<IClassFactory> factory = new HostFarmFactory(&m_farm, i);
+    DWORD cookie = 0;
+    spec.result = CoRegisterClassObject(
+        spec.alias, factory, spec.clsctx_register,
+        REGCLS_MULTIPLEUSE | REGCLS_MULTI_SEPARATE, &cookie
+    );
+    if (FAILED(spec.result)) {
+      QString text = QString(R"(
+Error: Class Registration Failed
+
+CoRegisterClassObject failed for the farm front.
+
+CLSID: '%1'
+
+Error message:
+%2)")
+                         .arg(spec.alias.toString())
+                         .arg(GetLastErrorMessage(HRESULT_CODE(spec.result)))
+                         .trimmed();
+      Diagnostics::Error(text);
+      continue;
     }
+    m_cookies.append(cookie);
+  }
+  if (m_cookies.isEmpty()) {
+    ExitApplicationLater();
+    return;
+  }
+  m_farm.Start();
+}
+
+RunAsFarm::~RunAsFarm() {
+  for (DWORD cookie : m_cookies) {
+    CoRevokeClassObject(cookie);
   }
 }
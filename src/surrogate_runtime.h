@@ -22,17 +22,22 @@
 #include <atomic>
 
 #include <atlcomcli.h>
+#include <wil/resource.h>
 #include <windows.h>
 
-#include <QAbstractEventDispatcher>
 #include <QCoreApplication>
 #include <QElapsedTimer>
 #include <QObject>
+#include <QScopedPointer>
 #include <QTimer>
 
 #include "class_spec.h"
+#include "idle_policy.h"
+#include "library_scheduler.h"
 #include "ready_event.h"
+#include "stats_page.h"
 #include "surrogate.h"
+#include "worker_farm.h"
 
 class HostSurrogateRuntime : public QObject {
   Q_OBJECT
@@ -42,21 +47,30 @@ protected:
 
   CComPtr<HostSurrogate> m_surrogate;
 
-  ulong m_freeUnusedLibrariesInterval = 60000;
-  QElapsedTimer m_freeUnusedLibrariesTimer;
+  HostLibraryScheduler m_libraryScheduler;
 
   ulong m_checkForExitTimeout = 60000;
   QTimer m_checkForExitTimer;
 
+  QScopedPointer<IdlePolicy> m_idlePolicy;
+  QElapsedTimer m_idleTimer;
+
+  StatsMapping m_stats;
+  QTimer m_statsTimer;
+  qint64 m_startTime = 0;
+
+  std::atomic<ulong> m_serverReferenceCount{0};
   std::atomic<ulong> m_acquisitionCount{0};
 
   bool m_warnedIdle = false;
   bool m_hasMultipleUse = false;
+  std::atomic<bool> m_exiting{false};
+  std::atomic<bool> m_classObjectsSuspended{false};
 
 protected:
   void InitializeStaticInstance();
-  void StartUnusedLibraryCleaner();
   void StartExitConditionChecker();
+  void StartStatsPublisher();
 
 public:
   HostSurrogateRuntime(QObject *parent = nullptr);
@@ -64,12 +78,14 @@ public:
 
   static HostSurrogateRuntime *instance();
 
+  void SetIdlePolicy(IdlePolicy *policy);
+  HostLibraryScheduler *GetLibraryScheduler();
+
 protected slots:
   void CheckForExit();
   void CheckForExitLater();
-
-  void FreeUnusedLibraries();
-  void OnAboutToBlock();
+  void OnServerReferenceAdded();
+  void PublishStats();
 
 public slots:
   virtual void AddServerReference();
@@ -89,6 +105,7 @@ class RunAsStandalone : public HostSurrogateRuntime {
 
 private:
   HostReadyEvent m_readyEvent;
+  wil::unique_event m_activatedEvent;
 
 private:
   void CheckMultipleUse(QList<ClassSpec> &specs, DWORD regcls);
@@ -96,7 +113,7 @@ private:
 public:
   RunAsStandalone(
       QList<ClassSpec> &specs, const QString &readyEvent, DWORD regcls,
-      QObject *parent = nullptr
+      const QString &activatedEvent = QString(), QObject *parent = nullptr
   );
   virtual ~RunAsStandalone() override;
 
@@ -105,4 +122,20 @@ public slots:
   virtual void ReleaseServerReference() override;
 };
 
+class RunAsFarm : public HostSurrogateRuntime {
+  Q_OBJECT
+
+private:
+  HostWorkerFarm m_farm;
+  QList<DWORD> m_cookies;
+
+public:
+  RunAsFarm(
+      QList<ClassSpec> &specs, int workers, FarmBalance balance,
+      const QStringList &arguments, const QString &readyEvent,
+      QObject *parent = nullptr
+  );
+  virtual ~RunAsFarm() override;
+};
+
 #endif // SURROGATE_RUNTIME_H
@@ -0,0 +1,231 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "type_info_cache.h"
+
+#include <chrono>
+#include <string>
+
+#include <wil/registry.h>
+#include <wil/resource.h>
+#include <wil/result.h>
+
+#include <QMutexLocker>
+
+// RegistryTypeLibProvider implementation
+
+HRESULT
+RegistryTypeLibProvider::ReadTypeLibId(REFCLSID rclsid, GUID *pLibid) {
+  if (!pLibid)
+    return E_POINTER;
+
+  wil::unique_cotaskmem_string clsidStr;
+  HRESULT hr = StringFromCLSID(rclsid, &clsidStr);
+  if (FAILED(hr))
+    return hr;
+
+  std::wstring key = L"CLSID\\";
+  key += clsidStr.get();
+  key += L"\\TypeLib";
+
+  wil::unique_hkey hKey;
+  hr = wil::reg::open_unique_key_nothrow(
+      HKEY_CLASSES_ROOT, key.c_str(), hKey, wil::reg::key_access::read
+  );
+  if (FAILED(hr))
+    return hr;
+
+  wchar_t buf[64];
+  DWORD sz = sizeof(buf);
+  LONG rc =
+      RegQueryValueExW(hKey.get(), nullptr, nullptr, nullptr, (LPBYTE)buf, &sz);
+  if (rc != ERROR_SUCCESS)
+    return HRESULT_FROM_WIN32(rc);
+
+  return CLSIDFromString(buf, pLibid);
+}
+
+HRESULT RegistryTypeLibProvider::FindLatestVersion(
+    REFGUID libid, USHORT *pMajor, USHORT *pMinor
+) {
+  if (!pMajor || !pMinor)
+    return E_POINTER;
+  *pMajor = *pMinor = 0;
+
+  wil::unique_cotaskmem_string libStr;
+  HRESULT hr = StringFromCLSID(libid, &libStr);
+  if (FAILED(hr))
+    return hr;
+
+  std::wstring key = L"TypeLib\\";
+  key += libStr.get();
+
+  wil::unique_hkey hKey;
+  hr = wil::reg::open_unique_key_nothrow(
+      HKEY_CLASSES_ROOT, key.c_str(), hKey, wil::reg::key_access::read
+  );
+  if (FAILED(hr))
+    return TYPE_E_LIBNOTREGISTERED;
+
+  DWORD index = 0;
+  wchar_t name[64];
+  DWORD namelen = _countof(name);
+  LONG rc;
+  while ((rc = RegEnumKeyExW(
+              hKey.get(), index++, name, &namelen, nullptr, nullptr, nullptr,
+              nullptr
+          )) == ERROR_SUCCESS) {
+    unsigned x = 0, y = 0;
+    if (swscanf_s(name, L"%u.%u", &x, &y) == 2) {
+      if (x > *pMajor || (x == *pMajor && y > *pMinor)) {
+        *pMajor = (USHORT)x;
+        *pMinor = (USHORT)y;
+      }
+    }
+    namelen = _countof(name);
+  }
+
+  return (*pMajor || *pMinor) ? S_OK : TYPE_E_LIBNOTREGISTERED;
+}
+
+HRESULT RegistryTypeLibProvider::LoadTypeLib(
+    REFGUID libid, USHORT major, USHORT minor, ITypeLib **ppTL
+) {
+  return LoadRegTypeLib(libid, major, minor, LOCALE_USER_DEFAULT, ppTL);
+}
+
+// HostTypeInfoCache implementation
+
+// Long enough to spare a burst of activations the registry walk.
+static constexpr qint64 kDefaultFailureLifetime = 10000;
+
+ExpiringCache<QUuid, QSharedPointer<const HostTypeInfo>>
+    HostTypeInfoCache::g_entries(
+        [](const QSharedPointer<const HostTypeInfo> &info) {
+          return FAILED(info->result);
+        },
+        std::chrono::milliseconds(kDefaultFailureLifetime)
+    );
+QMutex HostTypeInfoCache::g_providerMutex;
+QSharedPointer<TypeLibProvider> HostTypeInfoCache::g_provider;
+
+QSharedPointer<TypeLibProvider> HostTypeInfoCache::GetProvider() {
+  QMutexLocker locker(&g_providerMutex);
+  if (!g_provider) {
+    g_provider = QSharedPointer<RegistryTypeLibProvider>::create();
+  }
+  return g_provider;
+}
+
+QSharedPointer<const HostTypeInfo>
+HostTypeInfoCache::Resolve(REFCLSID rclsid) {
+  QSharedPointer<TypeLibProvider> provider = GetProvider();
+  QSharedPointer<HostTypeInfo> info = QSharedPointer<HostTypeInfo>::create();
+  info->result = [&] {
+    RETURN_IF_FAILED(provider->ReadTypeLibId(rclsid, &info->libid));
+    RETURN_IF_FAILED(
+        provider->FindLatestVersion(info->libid, &info->major, &info->minor)
+    );
+    RETURN_IF_FAILED(provider->LoadTypeLib(
+        info->libid, info->major, info->minor, &info->typeLib
+    ));
+    if (!info->typeLib)
+      return E_UNEXPECTED;
+    RETURN_IF_FAILED(
+        info->typeLib->GetTypeInfoOfGuid(rclsid, &info->classInfo)
+    );
+    if (!info->classInfo)
+      return E_UNEXPECTED;
+    return S_OK;
+  }();
+  if (SUCCEEDED(info->result)) {
+    info->defaultSourceResult =
+        FindDefaultSourceIID(info->classInfo, &info->defaultSource);
+  }
+  return info;
+}
+
+QSharedPointer<const HostTypeInfo> HostTypeInfoCache::Lookup(REFCLSID rclsid) {
+  // LoadRegTypeLib may take a while, so concurrent lookups of the same class
+  // may both resolve it. The first result is kept.
+  return g_entries.Lookup(QUuid(rclsid), [&] { return Resolve(rclsid); });
+}
+
+void HostTypeInfoCache::SetProvider(
+    const QSharedPointer<TypeLibProvider> &provider
+) {
+  {
+    QMutexLocker locker(&g_providerMutex);
+    g_provider = provider;
+  }
+  g_entries.Clear();
+}
+
+void HostTypeInfoCache::SetFailureLifetime(qint64 msecs) {
+  g_entries.SetFailureLifetime(std::chrono::milliseconds(msecs));
+}
+
+void HostTypeInfoCache::Clear() { g_entries.Clear(); }
+
+HRESULT
+HostTypeInfoCache::FindDefaultSourceIID(ITypeInfo *pCoClassTI, GUID *pOut) {
+  if (!pCoClassTI || !pOut)
+    return E_POINTER;
+
+  *pOut = GUID_NULL;
+
+  for (UINT i = 0;; ++i) {
+    INT implFlags = 0;
+    HRESULT hr = pCoClassTI->GetImplTypeFlags(i, &implFlags);
+
+    if (FAILED(hr))
+      break;
+
+    const bool isDefault = !!(implFlags & IMPLTYPEFLAG_FDEFAULT);
+    const bool isSource = !!(implFlags & IMPLTYPEFLAG_FSOURCE);
+
+    if (!isDefault)
+      continue;
+    if (!isSource)
+      continue;
+
+    HREFTYPE href = 0;
+    hr = pCoClassTI->GetRefTypeOfImplType(i, &href);
+    if (FAILED(hr))
+      continue;
+
+    ITypeInfo *pTI;
+    hr = pCoClassTI->GetRefTypeInfo(href, &pTI);
+    if (FAILED(hr) || !pTI)
+      continue;
+
+    TYPEATTR *pTA = nullptr;
+    hr = pTI->GetTypeAttr(&pTA);
+    if (FAILED(hr) || !pTA) {
+      pTI->Release();
+      continue;
+    }
+
+    *pOut = pTA->guid;
+    pTI->ReleaseTypeAttr(pTA);
+    pTI->Release();
+    return S_OK;
+  }
+
+  return TYPE_E_ELEMENTNOTFOUND;
+}
@@ -0,0 +1,92 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef TYPE_INFO_CACHE_H
+#define TYPE_INFO_CACHE_H
+
+#include <windows.h>
+
+#include <atlcomcli.h>
+#include <oaidl.h>
+
+#include <QMutex>
+#include <QSharedPointer>
+#include <QUuid>
+
+#include "expiring_cache.h"
+
+// Source of the registration data the cache resolves. The registry-backed
+// implementation is used unless another one is installed, which allows the
+// cache to run against fake type libraries.
+class TypeLibProvider {
+public:
+  virtual ~TypeLibProvider() = default;
+
+  virtual HRESULT ReadTypeLibId(REFCLSID rclsid, GUID *pLibid) = 0;
+  virtual HRESULT
+  FindLatestVersion(REFGUID libid, USHORT *pMajor, USHORT *pMinor) = 0;
+  virtual HRESULT
+  LoadTypeLib(REFGUID libid, USHORT major, USHORT minor, ITypeLib **ppTL) = 0;
+};
+
+class RegistryTypeLibProvider : public TypeLibProvider {
+public:
+  HRESULT ReadTypeLibId(REFCLSID rclsid, GUID *pLibid) override;
+  HRESULT
+  FindLatestVersion(REFGUID libid, USHORT *pMajor, USHORT *pMinor) override;
+  HRESULT LoadTypeLib(
+      REFGUID libid, USHORT major, USHORT minor, ITypeLib **ppTL
+  ) override;
+};
+
+// Type information resolved for one class. 'result' is the outcome of the
+// lookup; on failure only it is meaningful.
+struct HostTypeInfo {
+  HRESULT result = E_UNEXPECTED;
+  GUID libid = GUID_NULL;
+  USHORT major = 0;
+  USHORT minor = 0;
+  CComPtr<ITypeLib> typeLib;
+  CComPtr<ITypeInfo> classInfo;
+  HRESULT defaultSourceResult = TYPE_E_ELEMENTNOTFOUND;
+  GUID defaultSource = GUID_NULL;
+};
+
+// Process-wide cache of type information by CLSID, so that containers of the
+// same class share one registry walk and one LoadRegTypeLib. Failed lookups
+// are only kept for a while, so a type library registered later is found.
+class HostTypeInfoCache {
+private:
+  static ExpiringCache<QUuid, QSharedPointer<const HostTypeInfo>> g_entries;
+  static QMutex g_providerMutex;
+  static QSharedPointer<TypeLibProvider> g_provider;
+
+  static QSharedPointer<TypeLibProvider> GetProvider();
+  static QSharedPointer<const HostTypeInfo> Resolve(REFCLSID rclsid);
+
+public:
+  static QSharedPointer<const HostTypeInfo> Lookup(REFCLSID rclsid);
+
+  static void SetProvider(const QSharedPointer<TypeLibProvider> &provider);
+  static void SetFailureLifetime(qint64 msecs);
+  static void Clear();
+
+  static HRESULT FindDefaultSourceIID(ITypeInfo *pCoClassTI, GUID *pOut);
+};
+
+#endif // TYPE_INFO_CACHE_H
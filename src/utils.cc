@@ -18,9 +18,13 @@
 
 #include "utils.h"
 
+#include <string>
+
 #include <wil/resource.h>
 
+#include <QByteArray>
 #include <QCoreApplication>
+#include <QString>
 
 QString GetLastErrorMessage(DWORD err) {
   wil::unique_hlocal_string buf;
@@ -46,3 +50,38 @@ BOOL ExitApplicationLater(int retcode) {
   }
   return false;
 }
+
+bool WriteToConsole(const QString &text, DWORD stdHandle) {
+  // axhost is a GUI application, so it only has standard handles when they
+  // are redirected. Otherwise the parent's console is attached, if any.
+  static wil::unique_hfile console;
+  HANDLE handle = GetStdHandle(stdHandle);
+  if (!handle || handle == INVALID_HANDLE_VALUE) {
+    if (!console) {
+      if (!AttachConsole(ATTACH_PARENT_PROCESS) &&
+          GetLastError() != ERROR_ACCESS_DENIED)
+        return false;
+      console.reset(CreateFileW(
+          L"CONOUT$", GENERIC_READ | GENERIC_WRITE,
+          FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, 0,
+          nullptr
+      ));
+      if (!console)
+        return false;
+    }
+    handle = console.get();
+  }
+  DWORD written = 0;
+  if (GetFileType(handle) == FILE_TYPE_CHAR) {
+    std::wstring wide = text.toStdWString();
+    return WriteConsoleW(
+        handle, wide.c_str(), static_cast<DWORD>(wide.size()), &written,
+        nullptr
+    );
+  }
+  QByteArray utf8 = text.toUtf8();
+  return WriteFile(
+      handle, utf8.constData(), static_cast<DWORD>(utf8.size()), &written,
+      nullptr
+  );
+}
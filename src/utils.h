@@ -27,4 +27,8 @@ QString GetLastErrorMessage(DWORD err = GetLastError());
 
 BOOL ExitApplicationLater(int retcode = 0);
 
+// Writes to the redirected standard output or error, or else to the console
+// of the parent process. Returns false if there is neither.
+bool WriteToConsole(const QString &text, DWORD stdHandle = STD_OUTPUT_HANDLE);
+
 #endif // UTILS_H
@@ -0,0 +1,41 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "wait_handle_pool.h"
+
+QThreadStorage<QSharedPointer<HandlePool<HANDLE>>> HostWaitHandlePool::g_tls;
+HandlePoolCounts HostWaitHandlePool::g_counts;
+
+HandlePool<HANDLE> &HostWaitHandlePool::GetPool() {
+  if (!g_tls.hasLocalData()) {
+    g_tls.setLocalData(QSharedPointer<HandlePool<HANDLE>>::create(
+        kMaxPooledHandles, &g_counts,
+        [] { return CreateEventW(nullptr, FALSE, FALSE, nullptr); },
+        [](HANDLE handle) { CloseHandle(handle); }
+    ));
+  }
+  return *g_tls.localData();
+}
+
+HANDLE HostWaitHandlePool::Acquire() { return GetPool().Acquire(); }
+
+void HostWaitHandlePool::Release(HANDLE handle) { GetPool().Release(handle); }
+
+quint64 HostWaitHandlePool::GetCreatedCount() { return g_counts.created; }
+
+quint64 HostWaitHandlePool::GetReusedCount() { return g_counts.reused; }
@@ -0,0 +1,49 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef WAIT_HANDLE_POOL_H
+#define WAIT_HANDLE_POOL_H
+
+#include <windows.h>
+
+#include <QSharedPointer>
+#include <QThreadStorage>
+
+#include "handle_pool.h"
+
+// Per-thread pool of auto-reset events used to wait for synchronous event
+// deliveries. A handle may only be returned to the pool of the thread that
+// acquired it, and only after its signal has been consumed by a wait.
+class HostWaitHandlePool {
+private:
+  static constexpr std::size_t kMaxPooledHandles = 16;
+
+  static QThreadStorage<QSharedPointer<HandlePool<HANDLE>>> g_tls;
+  static HandlePoolCounts g_counts;
+
+  static HandlePool<HANDLE> &GetPool();
+
+public:
+  static HANDLE Acquire();
+  static void Release(HANDLE handle);
+
+  static quint64 GetCreatedCount();
+  static quint64 GetReusedCount();
+};
+
+#endif // WAIT_HANDLE_POOL_H
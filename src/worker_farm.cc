@@ -0,0 +1,380 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "worker_farm.h"
+
+#include <string>
+#include <vector>
+
+#include <wil/result.h>
+
+#include "spdlog/spdlog.h"
+
+#include "diagnostics.h"
+#include "process_pool.h"
+#include "registry_helper.h"
+#include "surrogate_runtime.h"
+#include "utils.h"
+
+static constexpr int kMaxConsecutiveFailures = 5;
+static constexpr int kReplenishDelay = 1000;
+static constexpr DWORD kWorkerStartTimeout = 30000;
+static constexpr UINT kRetiredExitCode = 1;
+
+// Weight of the newest activation in the moving average of the latency.
+static constexpr double kLatencyWeight = 0.2;
+
+static bool IsDisconnected(HRESULT hr) {
+  return hr == RPC_E_DISCONNECTED || hr == CO_E_OBJNOTCONNECTED ||
+         hr == HRESULT_FROM_WIN32(RPC_S_SERVER_UNAVAILABLE) ||
+         hr == HRESULT_FROM_WIN32(RPC_S_CALL_FAILED);
+}
+
+// HostWorkerFarm implementation
+
+HostWorkerFarm::HostWorkerFarm(
+    const QList<ClassSpec> &specs, int size, FarmBalance balance,
+    const QStringList &arguments, const QString &readyEvent, QObject *parent
+)
+    : QObject(parent),
+      m_specs(specs),
+      m_size(size),
+      m_balance(balance),
+      m_program(GetExecutablePath()),
+      m_arguments(arguments.mid(1)),
+      m_readyEvent(readyEvent) {
+  for (ClassSpec &spec : m_specs) {
+    spec.sanitize(REGCLS_MULTIPLEUSE);
+  }
+  m_replenishTimer.setSingleShot(true);
+  connect(
+      &m_replenishTimer, &QTimer::timeout, this, &HostWorkerFarm::Replenish
+  );
+}
+
+HostWorkerFarm::~HostWorkerFarm() {
+  for (const QSharedPointer<Worker> &worker : m_workers) {
+    spdlog::info(
+        "Farm worker {}: {} activations, {:.1f} ms average latency",
+        worker->id.toStdString(), worker->activations, worker->latency
+    );
+  }
+}
+
+void HostWorkerFarm::Start() {
+  spdlog::info("Worker farm started with {} workers", m_size);
+  Replenish();
+}
+
+bool HostWorkerFarm::Launch() {
+  QSharedPointer<Worker> worker = QSharedPointer<Worker>::create();
+  worker->id = QString("%1_w%2").arg(GetCurrentProcessId()).arg(m_nextWorker++);
+
+  std::wstring readyName = ReadyEventName(worker->id).toStdWString();
+  worker->ready.reset(CreateEventW(nullptr, TRUE, FALSE, readyName.c_str()));
+  if (!worker->ready)
+    return false;
+
+  QStringList arguments = m_arguments;
+  arguments << "--farm-worker" << worker->id;
+  if (!LaunchChildProcess(m_program, arguments, worker->process))
+    return false;
+
+  QString id = worker->id;
+  QWinEventNotifier *readyNotifier = new QWinEventNotifier(worker->ready.get());
+  QWinEventNotifier *exitNotifier =
+      new QWinEventNotifier(worker->process.hProcess);
+  connect(readyNotifier, &QWinEventNotifier::activated, this, [this, id] {
+    OnReady(id);
+  });
+  connect(exitNotifier, &QWinEventNotifier::activated, this, [this, id] {
+    OnExited(id);
+  });
+  worker->readyNotifier.reset(readyNotifier);
+  worker->exitNotifier.reset(exitNotifier);
+  m_workers.append(worker);
+  spdlog::debug(
+      "Farm worker {} launched (pid {})", id.toStdString(),
+      worker->process.dwProcessId
+  );
+  return true;
+}
+
+void HostWorkerFarm::Replenish() {
+  while (m_workers.size() < m_size) {
+    if (!Launch()) {
+      ++m_failureCount;
+      break;
+    }
+  }
+  if (m_failureCount >= kMaxConsecutiveFailures) {
+    QString text = QString(R"(
+Error: Farm Workers Failing
+
+%1 farm workers in a row failed to start. Exiting.
+)")
+                       .arg(m_failureCount)
+                       .trimmed();
+    Diagnostics::Error(text);
+    ExitApplicationLater(1);
+    return;
+  }
+  if (m_workers.size() < m_size && !m_replenishTimer.isActive()) {
+    m_replenishTimer.start(kReplenishDelay);
+  }
+}
+
+QSharedPointer<HostWorkerFarm::Worker>
+HostWorkerFarm::FindWorker(const QString &id) const {
+  for (const QSharedPointer<Worker> &worker : m_workers) {
+    if (worker->id == id)
+      return worker;
+  }
+  return nullptr;
+}
+
+void HostWorkerFarm::OnReady(const QString &id) {
+  QSharedPointer<Worker> worker = FindWorker(id);
+  if (!worker || worker->isReady)
+    return;
+  worker->readyNotifier->setEnabled(false);
+  worker->factories.clear();
+  for (const ClassSpec &spec : m_specs) {
+    CComPtr<IClassFactory> factory;
+    HRESULT hr = CoGetClassObject(
+        WorkerAlias(spec.alias, id), CLSCTX_LOCAL_SERVER, nullptr,
+        IID_IClassFactory, (void **)&factory
+    );
+    if (FAILED(hr)) {
+      spdlog::warn(
+          "Farm worker {}: class {} not available (0x{:08x})", id.toStdString(),
+          spec.alias.toString().toStdString(), static_cast<unsigned long>(hr)
+      );
+    }
+    worker->factories.append(factory);
+  }
+  worker->isReady = true;
+  m_failureCount = 0;
+  if (m_readySignaled)
+    return;
+  for (const QSharedPointer<Worker> &other : m_workers) {
+    if (!other->isReady)
+      return;
+  }
+  m_readySignaled = true;
+  m_readyEvent.SetEvent();
+}
+
+void HostWorkerFarm::OnExited(const QString &id) {
+  QSharedPointer<Worker> worker = FindWorker(id);
+  if (!worker)
+    return;
+  worker->exitNotifier->setEnabled(false);
+  m_workers.removeOne(worker);
+  DWORD exitCode = 0;
+  GetExitCodeProcess(worker->process.hProcess, &exitCode);
+  spdlog::warn(
+      "Farm worker {} exited with code {}, starting a replacement",
+      id.toStdString(), exitCode
+  );
+  if (!worker->isReady) {
+    ++m_failureCount;
+    if (!m_replenishTimer.isActive()) {
+      m_replenishTimer.start(kReplenishDelay);
+    }
+    return;
+  }
+  Replenish();
+}
+
+void HostWorkerFarm::Retire(const QSharedPointer<Worker> &worker) {
+  // Nested activations on the same worker may fail as well.
+  if (!m_workers.removeOne(worker))
+    return;
+  worker->readyNotifier->setEnabled(false);
+  worker->exitNotifier->setEnabled(false);
+  worker->isReady = false;
+  worker->factories.clear();
+  // A worker that is still running but cannot serve activations would hold
+  // its slot forever, so it is ended and a replacement takes over.
+  TerminateProcess(worker->process.hProcess, kRetiredExitCode);
+  spdlog::warn(
+      "Farm worker {} retired, starting a replacement",
+      worker->id.toStdString()
+  );
+  Replenish();
+}
+
+QSharedPointer<HostWorkerFarm::Worker> HostWorkerFarm::SelectWorker() const {
+  QSharedPointer<Worker> selected;
+  for (const QSharedPointer<Worker> &worker : m_workers) {
+    if (!worker->isReady)
+      continue;
+    if (!selected) {
+      selected = worker;
+      continue;
+    }
+    // Ties go to the worker that has served fewer activations so far.
+    bool better = false;
+    if (m_balance == FarmBalance::Latency &&
+        worker->latency != selected->latency) {
+      better = worker->latency < selected->latency;
+    } else if (worker->pending != selected->pending) {
+      better = worker->pending < selected->pending;
+    } else {
+      better = worker->activations < selected->activations;
+    }
+    if (better) {
+      selected = worker;
+    }
+  }
+  return selected;
+}
+
+HRESULT HostWorkerFarm::WaitForWorker() {
+  std::vector<HANDLE> handles;
+  QStringList ids;
+  for (const QSharedPointer<Worker> &worker : m_workers) {
+    if (!worker->isReady) {
+      handles.push_back(worker->ready.get());
+      ids.append(worker->id);
+    }
+  }
+  if (handles.empty())
+    return CO_E_SERVER_EXEC_FAILURE;
+  DWORD index = 0;
+  RETURN_IF_FAILED(CoWaitForMultipleHandles(
+      COWAIT_DISPATCH_CALLS, kWorkerStartTimeout, DWORD(handles.size()),
+      handles.data(), &index
+  ));
+  OnReady(ids[index]);
+  return S_OK;
+}
+
+HRESULT
+HostWorkerFarm::CreateInstance(qsizetype index, REFIID riid, void **ppv) {
+  // A worker that died since it was selected is retried once on another.
+  HRESULT hr = CO_E_SERVER_EXEC_FAILURE;
+  for (int attempt = 0; attempt < 2; ++attempt) {
+    QSharedPointer<Worker> worker = SelectWorker();
+    if (!worker) {
+      RETURN_IF_FAILED(WaitForWorker());
+      worker = SelectWorker();
+      if (!worker)
+        return CO_E_SERVER_EXEC_FAILURE;
+    }
+    // A worker that could not hand out the class object when it became
+    // ready is replaced, like one that stopped answering.
+    CComPtr<IClassFactory> factory = worker->factories.value(index);
+    if (!factory) {
+      hr = CLASS_E_CLASSNOTAVAILABLE;
+      Retire(worker);
+      continue;
+    }
+
+    // Incoming activations are dispatched while this one is in flight, so
+    // pending counts the outstanding activations of each worker.
+    QElapsedTimer timer;
+    timer.start();
+    ++worker->pending;
+    hr = factory->CreateInstance(nullptr, riid, ppv);
+    --worker->pending;
+    double elapsed = timer.nsecsElapsed() / 1e6;
+
+    if (IsDisconnected(hr)) {
+      Retire(worker);
+      continue;
+    }
+    ++worker->activations;
+    worker->latency = worker->activations == 1
+                          ? elapsed
+                          : worker->latency +
+                                kLatencyWeight * (elapsed - worker->latency);
+    return hr;
+  }
+  return hr;
+}
+
+QUuid HostWorkerFarm::WorkerAlias(const QUuid &alias, const QString &id) {
+  return QUuid::createUuidV5(alias, id);
+}
+
+QString HostWorkerFarm::ReadyEventName(const QString &id) {
+  return QString("Local\\AxHost_Farm_%1_Ready").arg(id);
+}
+
+bool HostWorkerFarm::parseBalance(const QString &name, FarmBalance &balance) {
+  if (name == "pending") {
+    balance = FarmBalance::Pending;
+  } else if (name == "latency") {
+    balance = FarmBalance::Latency;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// HostFarmFactory implementation
+
+HostFarmFactory::HostFarmFactory(HostWorkerFarm *farm, qsizetype index)
+    : m_farm(farm),
+      m_index(index) {}
+
+ULONG STDMETHODCALLTYPE HostFarmFactory::AddRef() { return ++m_ref; }
+
+ULONG STDMETHODCALLTYPE HostFarmFactory::Release() {
+  ULONG n = --m_ref;
+  if (n == 0)
+    delete this;
+  return n;
+}
+
+HRESULT STDMETHODCALLTYPE
+HostFarmFactory::QueryInterface(REFIID riid, void **ppv) {
+  if (!ppv)
+    return E_POINTER;
+  *ppv = nullptr;
+  if (riid == IID_IUnknown || riid == IID_IClassFactory) {
+    *ppv = static_cast<IClassFactory *>(this);
+  } else {
+    return E_NOINTERFACE;
+  }
+  AddRef();
+  return S_OK;
+}
+
+HRESULT STDMETHODCALLTYPE HostFarmFactory::LockServer(BOOL fLock) {
+  if (auto *runtime = HostSurrogateRuntime::instance()) {
+    if (fLock) {
+      runtime->AddServerReference();
+    } else {
+      runtime->ReleaseServerReference();
+    }
+  }
+  return S_OK;
+}
+
+HRESULT STDMETHODCALLTYPE
+HostFarmFactory::CreateInstance(IUnknown *outer, REFIID riid, void **ppv) {
+  if (!ppv)
+    return E_POINTER;
+  *ppv = nullptr;
+  if (outer)
+    return CLASS_E_NOAGGREGATION;
+  return m_farm->CreateInstance(m_index, riid, ppv);
+}
@@ -0,0 +1,129 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef WORKER_FARM_H
+#define WORKER_FARM_H
+
+#include <atomic>
+
+#include <windows.h>
+
+#include <atlcomcli.h>
+#include <wil/resource.h>
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <QScopedPointer>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <QUuid>
+#include <QWinEventNotifier>
+
+#include "class_spec.h"
+#include "ready_event.h"
+
+enum class FarmBalance {
+  Pending,
+  Latency,
+};
+
+// Backend axhost processes serving the classes of a front process. Each
+// worker registers every class under an alias of its own, and the front
+// forwards activations to the worker picked by the balance policy. The
+// client receives the worker's object, so calls never pass the front.
+class HostWorkerFarm : public QObject {
+  Q_OBJECT
+
+private:
+  struct Worker {
+    QString id;
+    wil::unique_process_information process;
+    wil::unique_event ready;
+    QScopedPointer<QWinEventNotifier> readyNotifier;
+    QScopedPointer<QWinEventNotifier> exitNotifier;
+    bool isReady = false;
+    QList<CComPtr<IClassFactory>> factories;
+    int pending = 0;
+    quint64 activations = 0;
+    double latency = 0;
+  };
+
+  QList<ClassSpec> m_specs;
+  int m_size;
+  FarmBalance m_balance;
+  QString m_program;
+  QStringList m_arguments;
+  HostReadyEvent m_readyEvent;
+  bool m_readySignaled = false;
+
+  QList<QSharedPointer<Worker>> m_workers;
+  int m_nextWorker = 0;
+  int m_failureCount = 0;
+  QTimer m_replenishTimer;
+
+  bool Launch();
+  void Replenish();
+  void OnReady(const QString &id);
+  void OnExited(const QString &id);
+  void Retire(const QSharedPointer<Worker> &worker);
+  QSharedPointer<Worker> FindWorker(const QString &id) const;
+  QSharedPointer<Worker> SelectWorker() const;
+  HRESULT WaitForWorker();
+
+public:
+  HostWorkerFarm(
+      const QList<ClassSpec> &specs, int size, FarmBalance balance,
+      const QStringList &arguments, const QString &readyEvent,
+      QObject *parent = nullptr
+  );
+  ~HostWorkerFarm();
+
+  void Start();
+  HRESULT CreateInstance(qsizetype index, REFIID riid, void **ppv);
+
+  static QUuid WorkerAlias(const QUuid &alias, const QString &id);
+  static QString ReadyEventName(const QString &id);
+  static bool parseBalance(const QString &name, FarmBalance &balance);
+};
+
+// Class factory of the front process. Every activation is forwarded to a
+// worker of the farm.
+class HostFarmFactory : public IClassFactory {
+private:
+  std::atomic<ULONG> m_ref{0};
+
+  HostWorkerFarm *m_farm;
+  qsizetype m_index;
+
+public:
+  HostFarmFactory(HostWorkerFarm *farm, qsizetype index);
+
+  ULONG STDMETHODCALLTYPE AddRef() override;
+  ULONG STDMETHODCALLTYPE Release() override;
+
+  HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void **ppv) override;
+
+  HRESULT STDMETHODCALLTYPE LockServer(BOOL fLock) override;
+  HRESULT STDMETHODCALLTYPE
+  CreateInstance(IUnknown *outer, REFIID riid, void **ppv) override;
+};
+
+#endif // WORKER_FARM_H
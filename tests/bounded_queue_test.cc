@@ -0,0 +1,117 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "bounded_queue.h"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "check.h"
+
+static void TestCapacity() {
+  BoundedQueue<int> queue(5);
+  CHECK(queue.Capacity() == 8);
+  CHECK(queue.IsEmpty());
+  CHECK(BoundedQueue<int>(1).Capacity() == 1);
+  CHECK(BoundedQueue<int>(64).Capacity() == 64);
+}
+
+static void TestFifo() {
+  BoundedQueue<int> queue(4);
+  for (int i = 0; i < 4; ++i) {
+    CHECK(queue.TryPush(i));
+  }
+  CHECK(!queue.TryPush(4));
+  CHECK(queue.Size() == 4);
+  int value = -1;
+  for (int i = 0; i < 4; ++i) {
+    CHECK(queue.TryPop(value));
+    CHECK(value == i);
+  }
+  CHECK(!queue.TryPop(value));
+  CHECK(queue.IsEmpty());
+}
+
+static void TestPushEvicting() {
+  BoundedQueue<int> queue(2);
+  int evicted = -1;
+  CHECK(!queue.PushEvicting(1, evicted));
+  CHECK(!queue.PushEvicting(2, evicted));
+  CHECK(queue.PushEvicting(3, evicted));
+  CHECK(evicted == 1);
+  CHECK(queue.PushEvicting(4, evicted));
+  CHECK(evicted == 2);
+  int value = -1;
+  CHECK(queue.TryPop(value) && value == 3);
+  CHECK(queue.TryPop(value) && value == 4);
+  CHECK(!queue.TryPop(value));
+}
+
+// The producer evicts while the consumer pops. Every value must come out
+// exactly once, either popped or evicted, and pops must stay in order.
+static void TestConcurrentEviction() {
+  static constexpr uint32_t kCount = 1000000;
+
+  BoundedQueue<uint32_t> queue(64);
+  std::vector<std::atomic<uint8_t>> seen(kCount);
+  std::atomic<bool> done{false};
+  std::atomic<bool> ordered{true};
+
+  std::thread consumer([&] {
+    uint32_t last = 0;
+    bool first = true;
+    uint32_t value = 0;
+    while (true) {
+      if (queue.TryPop(value)) {
+        if (!first && value <= last) {
+          ordered = false;
+        }
+        first = false;
+        last = value;
+        seen[value]++;
+      } else if (done.load(std::memory_order_acquire)) {
+        if (queue.IsEmpty())
+          break;
+      }
+    }
+  });
+
+  uint32_t evicted = 0;
+  for (uint32_t i = 0; i < kCount; ++i) {
+    if (queue.PushEvicting(i, evicted)) {
+      seen[evicted]++;
+    }
+  }
+  done.store(true, std::memory_order_release);
+  consumer.join();
+
+  CHECK(ordered);
+  for (uint32_t i = 0; i < kCount; ++i) {
+    CHECK(seen[i] == 1);
+  }
+}
+
+int main() {
+  TestCapacity();
+  TestFifo();
+  TestPushEvicting();
+  TestConcurrentEviction();
+  return 0;
+}
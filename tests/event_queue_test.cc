@@ -0,0 +1,375 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "event_queue.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "check.h"
+
+// Stands in for an event call. The value stands in for its arguments.
+class FakeCall {
+public:
+  enum State {
+    Queued,
+    Updating,
+    Running,
+    Dropped,
+  };
+
+  std::atomic<int> ref{1};
+  std::atomic<State> state{Queued};
+
+  long dispIdMember = 0;
+  bool coalesced = false;
+  bool synchronous = false;
+  int value = 0;
+
+  void AddRef() { ++ref; }
+  void Release() { --ref; }
+
+  bool IsSynchronous() const { return synchronous; }
+
+  bool BeginDelivery() {
+    State expected = Queued;
+    return state.compare_exchange_strong(expected, Running);
+  }
+
+  bool TakeOver(FakeCall *newer) {
+    State expected = Queued;
+    if (!state.compare_exchange_strong(expected, Updating))
+      return false;
+    std::swap(value, newer->value);
+    state = Queued;
+    return true;
+  }
+
+  void MarkDropped() {
+    State expected = Queued;
+    state.compare_exchange_strong(expected, Dropped);
+  }
+};
+
+// Stands in for the sink. Deliveries can be held at a gate, which keeps the
+// consumer busy while the test fills the queue.
+class FakeSink : public EventDispatcher<FakeCall> {
+private:
+  std::mutex m_mutex;
+  std::condition_variable m_changed;
+  std::vector<int> m_delivered;
+  bool m_blocked = false;
+  int m_waitingAtGate = 0;
+  std::vector<std::thread> m_tasks;
+
+  std::atomic<int> m_delivering{0};
+  std::atomic<bool> m_overlapped{false};
+
+public:
+  ~FakeSink() { Join(); }
+
+  void Deliver(FakeCall *call) override {
+    if (++m_delivering > 1) {
+      m_overlapped = true;
+    }
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      ++m_waitingAtGate;
+      m_changed.notify_all();
+      m_changed.wait(lock, [this] { return !m_blocked; });
+      --m_waitingAtGate;
+      if (call->BeginDelivery()) {
+        m_delivered.push_back(call->value);
+      }
+      m_changed.notify_all();
+    }
+    --m_delivering;
+  }
+
+  void Schedule(std::function<void()> task) override {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_tasks.emplace_back(std::move(task));
+  }
+
+  void Block() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_blocked = true;
+  }
+
+  void Unblock() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_blocked = false;
+    m_changed.notify_all();
+  }
+
+  // Waits until a delivery is held at the gate.
+  void WaitUntilBlocked() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_changed.wait(lock, [this] { return m_waitingAtGate > 0; });
+  }
+
+  void WaitForDeliveries(size_t count) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_changed.wait(lock, [&] { return m_delivered.size() >= count; });
+  }
+
+  std::vector<int> Delivered() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_delivered;
+  }
+
+  void Join() {
+    std::vector<std::thread> tasks;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      tasks.swap(m_tasks);
+    }
+    for (std::thread &task : tasks) {
+      task.join();
+    }
+  }
+
+  bool Overlapped() const { return m_overlapped; }
+};
+
+static std::vector<int> Range(int first, int last) {
+  std::vector<int> values;
+  for (int i = first; i <= last; ++i) {
+    values.push_back(i);
+  }
+  return values;
+}
+
+static void CheckReleased(const std::vector<FakeCall> &calls) {
+  for (const FakeCall &call : calls) {
+    CHECK(call.ref == 1);
+  }
+  CHECK(EventQueue<FakeCall>::GetQueuedCount() == 0);
+}
+
+// The producer outruns the consumer, so it keeps waiting for space, and in
+// the pooled mode drain tasks keep handing over to each other.
+static void TestFifo(bool pooled) {
+  static constexpr int kCount = 20000;
+
+  FakeSink sink;
+  std::vector<FakeCall> calls(kCount);
+  {
+    EventQueue<FakeCall> queue(64, EventOverflow::Block, &sink, pooled);
+    queue.Start();
+    for (int i = 0; i < kCount; ++i) {
+      calls[i].value = i;
+      CHECK(queue.PostAsync(&calls[i]) == EventPostResult::Queued);
+    }
+    sink.WaitForDeliveries(kCount);
+    queue.Stop();
+    sink.Join();
+    CHECK(queue.GetPostedCount() == kCount);
+    CHECK(queue.GetDroppedCount() == 0);
+  }
+  CHECK(sink.Delivered() == Range(0, kCount - 1));
+  CHECK(!sink.Overlapped());
+  CheckReleased(calls);
+}
+
+static void TestDropNewest() {
+  FakeSink sink;
+  std::vector<FakeCall> calls(7);
+  {
+    EventQueue<FakeCall> queue(4, EventOverflow::DropNewest, &sink, false);
+    queue.Start();
+    sink.Block();
+    for (int i = 0; i < 7; ++i) {
+      calls[i].value = i;
+    }
+    CHECK(queue.PostAsync(&calls[0]) == EventPostResult::Queued);
+    sink.WaitUntilBlocked();
+    for (int i = 1; i <= 4; ++i) {
+      CHECK(queue.PostAsync(&calls[i]) == EventPostResult::Queued);
+    }
+    CHECK(queue.PostAsync(&calls[5]) == EventPostResult::Dropped);
+    CHECK(queue.PostAsync(&calls[6]) == EventPostResult::Dropped);
+    CHECK(calls[5].state == FakeCall::Dropped);
+    sink.Unblock();
+    queue.Stop();
+    CHECK(queue.GetDroppedCount() == 2);
+  }
+  CHECK(sink.Delivered() == Range(0, 4));
+  CheckReleased(calls);
+}
+
+static void TestDropOldest() {
+  FakeSink sink;
+  std::vector<FakeCall> calls(7);
+  {
+    EventQueue<FakeCall> queue(4, EventOverflow::DropOldest, &sink, false);
+    queue.Start();
+    sink.Block();
+    for (int i = 0; i < 7; ++i) {
+      calls[i].value = i;
+    }
+    CHECK(queue.PostAsync(&calls[0]) == EventPostResult::Queued);
+    sink.WaitUntilBlocked();
+    for (int i = 1; i < 7; ++i) {
+      CHECK(queue.PostAsync(&calls[i]) == EventPostResult::Queued);
+    }
+    CHECK(calls[1].state == FakeCall::Dropped);
+    CHECK(calls[2].state == FakeCall::Dropped);
+    sink.Unblock();
+    queue.Stop();
+    CHECK(queue.GetDroppedCount() == 2);
+  }
+  CHECK(sink.Delivered() == std::vector<int>({0, 3, 4, 5, 6}));
+  CheckReleased(calls);
+}
+
+// A queued call whose caller waits for it is never evicted. The new events
+// are dropped instead until it has been delivered.
+static void TestSynchronousNotEvicted() {
+  FakeSink sink;
+  std::vector<FakeCall> calls(12);
+  {
+    EventQueue<FakeCall> queue(4, EventOverflow::DropOldest, &sink, false);
+    queue.Start();
+    for (int i = 0; i < 12; ++i) {
+      calls[i].value = i;
+    }
+    calls[1].synchronous = true;
+    sink.Block();
+    CHECK(queue.PostAsync(&calls[0]) == EventPostResult::Queued);
+    sink.WaitUntilBlocked();
+    CHECK(queue.Post(&calls[1]) == EventPostResult::Queued);
+    for (int i = 2; i <= 4; ++i) {
+      CHECK(queue.PostAsync(&calls[i]) == EventPostResult::Queued);
+    }
+    CHECK(queue.PostAsync(&calls[5]) == EventPostResult::Dropped);
+    CHECK(calls[1].state == FakeCall::Queued);
+    sink.Unblock();
+    sink.WaitForDeliveries(5);
+
+    // Once it has been delivered, the oldest events are evicted again.
+    sink.Block();
+    CHECK(queue.PostAsync(&calls[6]) == EventPostResult::Queued);
+    sink.WaitUntilBlocked();
+    for (int i = 7; i <= 11; ++i) {
+      CHECK(queue.PostAsync(&calls[i]) == EventPostResult::Queued);
+    }
+    CHECK(calls[7].state == FakeCall::Dropped);
+    sink.Unblock();
+    queue.Stop();
+    CHECK(queue.GetDroppedCount() == 2);
+  }
+  CHECK(
+      sink.Delivered() == std::vector<int>({0, 1, 2, 3, 4, 6, 8, 9, 10, 11})
+  );
+  CheckReleased(calls);
+}
+
+static void TestBlockWaitsForSpace() {
+  FakeSink sink;
+  std::vector<FakeCall> calls(4);
+  {
+    EventQueue<FakeCall> queue(2, EventOverflow::Block, &sink, false);
+    queue.Start();
+    for (int i = 0; i < 4; ++i) {
+      calls[i].value = i;
+    }
+    sink.Block();
+    CHECK(queue.PostAsync(&calls[0]) == EventPostResult::Queued);
+    sink.WaitUntilBlocked();
+    CHECK(queue.PostAsync(&calls[1]) == EventPostResult::Queued);
+    CHECK(queue.PostAsync(&calls[2]) == EventPostResult::Queued);
+    std::thread unblock([&] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      sink.Unblock();
+    });
+    CHECK(queue.PostAsync(&calls[3]) == EventPostResult::Queued);
+    unblock.join();
+    queue.Stop();
+  }
+  CHECK(sink.Delivered() == Range(0, 3));
+  CheckReleased(calls);
+}
+
+static void TestCoalesced() {
+  FakeSink sink;
+  std::vector<FakeCall> calls(5);
+  {
+    EventQueue<FakeCall> queue(8, EventOverflow::Block, &sink, false);
+    queue.Start();
+    for (int i = 0; i < 5; ++i) {
+      calls[i].value = i;
+      calls[i].dispIdMember = i == 3 ? 8 : 7;
+    }
+    sink.Block();
+    CHECK(queue.PostAsync(&calls[0]) == EventPostResult::Queued);
+    sink.WaitUntilBlocked();
+    CHECK(queue.PostCoalesced(&calls[1]) == EventPostResult::Queued);
+    CHECK(queue.PostCoalesced(&calls[2]) == EventPostResult::Coalesced);
+    CHECK(calls[1].value == 2);
+    CHECK(calls[2].value == 1);
+    CHECK(queue.PostCoalesced(&calls[3]) == EventPostResult::Queued);
+    sink.Unblock();
+    sink.WaitForDeliveries(3);
+
+    // The delivered call has left the table, so the next one is queued.
+    CHECK(queue.PostCoalesced(&calls[4]) == EventPostResult::Queued);
+    queue.Stop();
+    CHECK(queue.GetPostedCount() == 4);
+  }
+  CHECK(sink.Delivered() == std::vector<int>({0, 2, 3, 4}));
+  CheckReleased(calls);
+}
+
+// Stop returns once the thread has delivered every queued call and has been
+// joined. Later events are refused.
+static void TestStop() {
+  FakeSink sink;
+  std::vector<FakeCall> calls(18);
+  {
+    EventQueue<FakeCall> queue(16, EventOverflow::Block, &sink, false);
+    queue.Start();
+    for (int i = 0; i < 16; ++i) {
+      calls[i].value = i;
+      CHECK(queue.PostAsync(&calls[i]) == EventPostResult::Queued);
+    }
+    queue.Stop();
+    CHECK(sink.Delivered() == Range(0, 15));
+    CHECK(queue.PostAsync(&calls[16]) == EventPostResult::Stopped);
+    CHECK(queue.PostCoalesced(&calls[17]) == EventPostResult::Stopped);
+    queue.Stop();
+  }
+  CHECK(sink.Delivered().size() == 16);
+  CheckReleased(calls);
+}
+
+int main() {
+  TestFifo(false);
+  TestFifo(true);
+  TestDropNewest();
+  TestDropOldest();
+  TestSynchronousNotEvicted();
+  TestBlockWaitsForSpace();
+  TestCoalesced();
+  TestStop();
+  return 0;
+}
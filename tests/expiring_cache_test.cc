@@ -0,0 +1,122 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "expiring_cache.h"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "check.h"
+
+// Stands in for the type information of a class. Failed lookups have a
+// negative result, like a failed HRESULT.
+struct Resolved {
+  long result = 0;
+  std::string library;
+};
+
+using ResolvedCache = ExpiringCache<std::string, std::shared_ptr<Resolved>>;
+
+static bool IsFailure(const std::shared_ptr<Resolved> &resolved) {
+  return resolved->result < 0;
+}
+
+// Resolves from a fake registration and counts how often it is asked.
+class FakeResolver {
+public:
+  long result = 0;
+  int count = 0;
+
+  std::shared_ptr<Resolved> operator()() {
+    ++count;
+    auto resolved = std::make_shared<Resolved>();
+    resolved->result = result;
+    resolved->library = result < 0 ? "" : "fake.tlb";
+    return resolved;
+  }
+};
+
+static void TestCachesSuccess() {
+  ResolvedCache cache(IsFailure, std::chrono::seconds(60));
+  FakeResolver resolver;
+  auto resolve = [&] { return resolver(); };
+  std::shared_ptr<Resolved> resolved = cache.Lookup("{A}", resolve);
+  CHECK(resolved->library == "fake.tlb");
+  CHECK(cache.Lookup("{A}", resolve) == resolved);
+  CHECK(resolver.count == 1);
+
+  // Other keys are resolved on their own.
+  CHECK(cache.Lookup("{B}", resolve) != resolved);
+  CHECK(resolver.count == 2);
+  CHECK(cache.Size() == 2);
+
+  cache.Clear();
+  CHECK(cache.Size() == 0);
+  CHECK(cache.Lookup("{A}", resolve) != resolved);
+  CHECK(resolver.count == 3);
+}
+
+static void TestExpiresFailures() {
+  ResolvedCache cache(IsFailure, std::chrono::seconds(60));
+  FakeResolver resolver;
+  auto resolve = [&] { return resolver(); };
+  resolver.result = -1;
+
+  // Within its lifetime a failure is answered from the cache.
+  CHECK(cache.Lookup("{A}", resolve)->result == -1);
+  CHECK(cache.Lookup("{A}", resolve)->result == -1);
+  CHECK(resolver.count == 1);
+
+  // Once it has expired, a class registered meanwhile is found.
+  cache.SetFailureLifetime(std::chrono::milliseconds(20));
+  std::this_thread::sleep_for(std::chrono::milliseconds(40));
+  resolver.result = 0;
+  std::shared_ptr<Resolved> resolved = cache.Lookup("{A}", resolve);
+  CHECK(resolved->result == 0);
+  CHECK(resolver.count == 2);
+
+  // Successes never expire.
+  cache.SetFailureLifetime(ResolvedCache::Clock::duration::zero());
+  CHECK(cache.Lookup("{A}", resolve) == resolved);
+  CHECK(resolver.count == 2);
+}
+
+// When another lookup stores its result while this one resolves, the
+// stored result is kept and returned.
+static void TestKeepsFirstResult() {
+  ResolvedCache cache(IsFailure, std::chrono::seconds(60));
+  FakeResolver resolver;
+  std::shared_ptr<Resolved> first;
+  std::shared_ptr<Resolved> second = cache.Lookup("{A}", [&] {
+    first = cache.Lookup("{A}", [&] { return resolver(); });
+    return resolver();
+  });
+  CHECK(resolver.count == 2);
+  CHECK(second == first);
+  CHECK(cache.Lookup("{A}", [&] { return resolver(); }) == first);
+  CHECK(resolver.count == 2);
+}
+
+int main() {
+  TestCachesSuccess();
+  TestExpiresFailures();
+  TestKeepsFirstResult();
+  return 0;
+}
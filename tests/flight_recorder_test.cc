@@ -0,0 +1,129 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "flight_recorder.h"
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "check.h"
+
+struct DecodedRecord {
+  std::string event;
+  uint64_t a;
+  uint64_t b;
+};
+
+// Parses the lines written by Decode back into their event, 'a' and 'b'.
+static std::vector<DecodedRecord> Parse(const std::string &text) {
+  std::vector<DecodedRecord> records;
+  std::istringstream lines(text);
+  std::string line;
+  while (std::getline(lines, line)) {
+    std::istringstream fields(line);
+    std::string time, unit, label, thread, event, a, b;
+    CHECK(fields >> time >> unit >> label >> thread >> event >> a >> b);
+    DecodedRecord record;
+    record.event = event;
+    record.a = std::stoull(a, nullptr, 16);
+    record.b = std::stoull(b, nullptr, 16);
+    records.push_back(record);
+  }
+  return records;
+}
+
+static std::vector<DecodedRecord> DumpAndDecode() {
+  std::stringstream dump;
+  CHECK(FlightRecorder::Dump(dump));
+  std::ostringstream text;
+  CHECK(FlightRecorder::Decode(dump, text));
+  return Parse(text.str());
+}
+
+// A thread writing more than a ring holds leaves only its newest records.
+static void TestWrapAround() {
+  static constexpr uint64_t kExtra = 100;
+  static constexpr uint64_t kCount = FlightRecorder::kRingCapacity + kExtra;
+
+  std::thread writer([] {
+    for (uint64_t i = 0; i < kCount; ++i) {
+      FlightRecorder::Record(FlightEvent::EventDelivery, i, 2 * i);
+    }
+  });
+  writer.join();
+
+  std::vector<DecodedRecord> records = DumpAndDecode();
+  CHECK(records.size() == FlightRecorder::kRingCapacity);
+  for (size_t i = 0; i < records.size(); ++i) {
+    CHECK(records[i].event == "EventDelivery");
+    CHECK(records[i].a == kExtra + i);
+    CHECK(records[i].b == 2 * (kExtra + i));
+  }
+}
+
+// Records of several threads come back merged in time order.
+static void TestThreads() {
+  FlightRecorder::Record(FlightEvent::ActivationBegin, 0xABC, 0);
+  std::thread other([] {
+    FlightRecorder::Record(FlightEvent::ContainerAddRef, 0x1234, 1);
+  });
+  other.join();
+  FlightRecorder::Record(FlightEvent::ActivationEnd, 0xABC, 0x80004005);
+
+  std::vector<DecodedRecord> records = DumpAndDecode();
+  CHECK(records.size() >= 3);
+  const DecodedRecord *last = &records[records.size() - 3];
+  CHECK(last[0].event == "ActivationBegin" && last[0].a == 0xABC);
+  CHECK(last[1].event == "ContainerAddRef" && last[1].a == 0x1234);
+  CHECK(last[1].b == 1);
+  CHECK(last[2].event == "ActivationEnd" && last[2].b == 0x80004005);
+}
+
+static void TestDisabled() {
+  size_t before = DumpAndDecode().size();
+  FlightRecorder::SetEnabled(false);
+  FlightRecorder::Record(FlightEvent::ServerReferenceAdded, 1, 1);
+  FlightRecorder::SetEnabled(true);
+  CHECK(DumpAndDecode().size() == before);
+}
+
+static void TestRejectsInvalidDumps() {
+  std::ostringstream text;
+  std::istringstream empty;
+  CHECK(!FlightRecorder::Decode(empty, text));
+  std::istringstream garbage(std::string(64, 'x'));
+  CHECK(!FlightRecorder::Decode(garbage, text));
+
+  // A dump cut off in the middle of a ring.
+  std::stringstream dump;
+  CHECK(FlightRecorder::Dump(dump));
+  std::string bytes = dump.str();
+  std::istringstream truncated(bytes.substr(0, bytes.size() - 1));
+  CHECK(!FlightRecorder::Decode(truncated, text));
+}
+
+int main() {
+  TestWrapAround();
+  TestThreads();
+  TestDisabled();
+  TestRejectsInvalidDumps();
+  return 0;
+}
@@ -0,0 +1,140 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "handle_pool.h"
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "check.h"
+
+// Stands in for the events of one thread: numbered handles, with the number
+// of open ones tracked.
+class FakeEvents {
+public:
+  uintptr_t next = 1;
+  int open = 0;
+  bool failing = false;
+  // Declared last, since it closes its handles when it is destroyed.
+  HandlePool<uintptr_t> pool;
+
+  FakeEvents(std::size_t limit, HandlePoolCounts *counts)
+      : pool(
+            limit, counts,
+            [this]() -> uintptr_t {
+              if (failing)
+                return 0;
+              ++open;
+              return next++;
+            },
+            [this](uintptr_t) { --open; }
+        ) {}
+};
+
+// Synchronous deliveries one after another wait on the same handle.
+static void TestSequentialDeliveries() {
+  HandlePoolCounts counts;
+  FakeEvents events(16, &counts);
+  for (int i = 0; i < 1000; ++i) {
+    uintptr_t handle = events.pool.Acquire();
+    CHECK(handle == 1);
+    events.pool.Release(handle);
+  }
+  CHECK(counts.created == 1);
+  CHECK(counts.reused == 999);
+  CHECK(events.open == 1);
+}
+
+// An event fired while the thread waits for another one needs a handle of
+// its own, so nesting creates one handle per level once.
+static void TestNestedDeliveries() {
+  static constexpr int kDepth = 3;
+
+  HandlePoolCounts counts;
+  FakeEvents events(16, &counts);
+  for (int i = 0; i < 100; ++i) {
+    std::vector<uintptr_t> waiting;
+    for (int level = 0; level < kDepth; ++level) {
+      waiting.push_back(events.pool.Acquire());
+    }
+    while (!waiting.empty()) {
+      events.pool.Release(waiting.back());
+      waiting.pop_back();
+    }
+  }
+  CHECK(counts.created == kDepth);
+  CHECK(events.pool.Size() == kDepth);
+}
+
+static void TestLimit() {
+  HandlePoolCounts counts;
+  {
+    FakeEvents events(2, &counts);
+    std::vector<uintptr_t> waiting;
+    for (int level = 0; level < 4; ++level) {
+      waiting.push_back(events.pool.Acquire());
+    }
+    for (uintptr_t handle : waiting) {
+      events.pool.Release(handle);
+    }
+    CHECK(events.pool.Size() == 2);
+    CHECK(events.open == 2);
+  }
+  CHECK(counts.created == 4);
+}
+
+static void TestCreateFailure() {
+  HandlePoolCounts counts;
+  FakeEvents events(16, &counts);
+  events.failing = true;
+  CHECK(events.pool.Acquire() == 0);
+  events.pool.Release(0);
+  CHECK(events.pool.Size() == 0);
+  CHECK(counts.created == 0);
+}
+
+// Every thread has a pool of its own, and the counts cover all of them.
+static void TestThreads() {
+  static constexpr int kThreadCount = 4;
+
+  HandlePoolCounts counts;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreadCount; ++i) {
+    threads.emplace_back([&] {
+      FakeEvents events(16, &counts);
+      for (int event = 0; event < 1000; ++event) {
+        events.pool.Release(events.pool.Acquire());
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  CHECK(counts.created == kThreadCount);
+  CHECK(counts.reused == kThreadCount * 999);
+}
+
+int main() {
+  TestSequentialDeliveries();
+  TestNestedDeliveries();
+  TestLimit();
+  TestCreateFailure();
+  TestThreads();
+  return 0;
+}
@@ -0,0 +1,138 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "lazy_member.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "check.h"
+
+struct FakeWrapper {
+  int connections = 0;
+};
+
+using FakeMember = LazyMember<std::shared_ptr<FakeWrapper>>;
+
+static std::shared_ptr<FakeWrapper> MakeWrapper() {
+  return std::make_shared<FakeWrapper>();
+}
+
+// Stands in for a pooled container: the same one serves activation after
+// activation, and its wrappers are built when a client first asks for them.
+class FakeContainer {
+public:
+  bool initialized = true;
+  FakeMember classInfo;
+  FakeMember connectionPoints;
+  FakeMember profiler;
+
+  explicit FakeContainer(std::atomic<uint64_t> *count)
+      : classInfo(count), connectionPoints(count), profiler(count) {}
+
+  std::shared_ptr<FakeWrapper> GetClassInfo() {
+    return classInfo.Get(MakeWrapper);
+  }
+
+  std::shared_ptr<FakeWrapper> GetConnectionPoints() {
+    return connectionPoints.Get(MakeWrapper);
+  }
+
+  // Needs the control, like the dispatch profiler.
+  std::shared_ptr<FakeWrapper> GetProfiler() {
+    return profiler.Get([this] {
+      if (!initialized)
+        return std::shared_ptr<FakeWrapper>();
+      return MakeWrapper();
+    });
+  }
+
+  bool HasConnections() const {
+    const std::shared_ptr<FakeWrapper> &wrapper = connectionPoints.Peek();
+    return wrapper && wrapper->connections > 0;
+  }
+};
+
+// Clients that only call through IDispatch never build a wrapper.
+static void TestDispatchOnly() {
+  std::atomic<uint64_t> count{0};
+  FakeContainer container(&count);
+  for (int i = 0; i < 100; ++i) {
+    CHECK(!container.HasConnections());
+  }
+  CHECK(count == 0);
+  CHECK(!container.classInfo.Peek());
+  CHECK(!container.connectionPoints.Peek());
+}
+
+// Every activation of a pooled container asks for the class info and the
+// connection points a few times, and the wrappers are built once.
+static void TestActivations() {
+  static constexpr int kActivationCount = 100;
+
+  std::atomic<uint64_t> count{0};
+  FakeContainer container(&count);
+  for (int i = 0; i < kActivationCount; ++i) {
+    std::shared_ptr<FakeWrapper> classInfo = container.GetClassInfo();
+    CHECK(container.GetClassInfo() == classInfo);
+    std::shared_ptr<FakeWrapper> points = container.GetConnectionPoints();
+    CHECK(container.GetConnectionPoints() == points);
+    ++points->connections;
+    CHECK(container.HasConnections());
+    --points->connections;
+    CHECK(!container.HasConnections());
+  }
+  CHECK(count == 2);
+}
+
+// Each container builds its own wrappers, into the shared count.
+static void TestContainers() {
+  static constexpr int kContainerCount = 10;
+
+  std::atomic<uint64_t> count{0};
+  for (int i = 0; i < kContainerCount; ++i) {
+    FakeContainer container(&count);
+    container.GetClassInfo();
+    container.GetClassInfo();
+  }
+  CHECK(count == kContainerCount);
+}
+
+// A wrapper that could not be built is not counted and is tried again.
+static void TestFailure() {
+  std::atomic<uint64_t> count{0};
+  FakeContainer container(&count);
+  container.initialized = false;
+  CHECK(!container.GetProfiler());
+  CHECK(!container.GetProfiler());
+  CHECK(count == 0);
+  container.initialized = true;
+  std::shared_ptr<FakeWrapper> profiler = container.GetProfiler();
+  CHECK(profiler);
+  CHECK(container.GetProfiler() == profiler);
+  CHECK(count == 1);
+}
+
+int main() {
+  TestDispatchOnly();
+  TestActivations();
+  TestContainers();
+  TestFailure();
+  return 0;
+}
@@ -0,0 +1,158 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "marshaler_cache.h"
+
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "check.h"
+
+struct FakeKey {
+  int riid;
+  uint32_t destContext;
+  uint32_t mshlflags;
+
+  bool operator<(const FakeKey &other) const {
+    return std::tie(riid, destContext, mshlflags) <
+           std::tie(other.riid, other.destContext, other.mshlflags);
+  }
+};
+
+struct FakeMarshaler {
+  int created;
+};
+
+using FakeCache = MarshalerCache<FakeKey, std::shared_ptr<FakeMarshaler>>;
+
+static constexpr int kUnknown = 0;
+static constexpr int kDispatch = 1;
+static constexpr uint32_t kLocal = 1;
+static constexpr uint32_t kInProcess = 3;
+
+// Stands in for the standard marshaler of one object.
+class FakeObject {
+public:
+  int created = 0;
+  bool failing = false;
+  FakeCache marshalers;
+
+  explicit FakeObject(MarshalerCacheCounts *counts) : marshalers(counts) {}
+
+  std::shared_ptr<FakeMarshaler> GetStandardMarshal(const FakeKey &key) {
+    return marshalers.Find(key, [this] {
+      if (failing)
+        return std::shared_ptr<FakeMarshaler>();
+      return std::make_shared<FakeMarshaler>(FakeMarshaler{++created});
+    });
+  }
+};
+
+// Marshaling the factory for a client calls GetUnmarshalClass,
+// GetMarshalSizeMax and MarshalInterface, each with the same key.
+static void TestActivations() {
+  static constexpr int kActivationCount = 100;
+
+  MarshalerCacheCounts counts;
+  FakeObject object(&counts);
+  FakeKey key{kUnknown, kLocal, 0};
+  for (int i = 0; i < kActivationCount; ++i) {
+    for (int call = 0; call < 3; ++call) {
+      CHECK(object.GetStandardMarshal(key)->created == 1);
+    }
+  }
+  CHECK(counts.created == 1);
+  CHECK(counts.reused == kActivationCount * 3 - 1);
+  CHECK(object.created == 1);
+}
+
+static void TestKeys() {
+  MarshalerCacheCounts counts;
+  FakeObject object(&counts);
+  object.GetStandardMarshal({kUnknown, kLocal, 0});
+  object.GetStandardMarshal({kUnknown, kInProcess, 0});
+  object.GetStandardMarshal({kDispatch, kLocal, 0});
+  object.GetStandardMarshal({kUnknown, kLocal, 1});
+  object.GetStandardMarshal({kUnknown, kInProcess, 0});
+  CHECK(counts.created == 4);
+  CHECK(counts.reused == 1);
+  CHECK(object.marshalers.Size() == 4);
+}
+
+// A failed creation is retried by the next call.
+static void TestFailure() {
+  MarshalerCacheCounts counts;
+  FakeObject object(&counts);
+  FakeKey key{kUnknown, kLocal, 0};
+  object.failing = true;
+  CHECK(!object.GetStandardMarshal(key));
+  CHECK(object.marshalers.Size() == 0);
+  object.failing = false;
+  CHECK(object.GetStandardMarshal(key));
+  CHECK(counts.created == 1);
+  CHECK(counts.reused == 0);
+}
+
+// Disconnecting drops the marshalers, and the next call creates a new one.
+static void TestClear() {
+  MarshalerCacheCounts counts;
+  FakeObject object(&counts);
+  FakeKey key{kUnknown, kLocal, 0};
+  std::weak_ptr<FakeMarshaler> first = object.GetStandardMarshal(key);
+  CHECK(!first.expired());
+  object.marshalers.Clear();
+  CHECK(first.expired());
+  CHECK(object.marshalers.Size() == 0);
+  CHECK(object.GetStandardMarshal(key)->created == 2);
+  CHECK(counts.created == 2);
+}
+
+// Clients marshal the factory from several threads at once.
+static void TestThreads() {
+  static constexpr int kThreadCount = 4;
+  static constexpr int kCallCount = 1000;
+
+  MarshalerCacheCounts counts;
+  FakeObject object(&counts);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreadCount; ++i) {
+    threads.emplace_back([&] {
+      for (int call = 0; call < kCallCount; ++call) {
+        object.GetStandardMarshal({kUnknown, kLocal, 0});
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  CHECK(counts.created == 1);
+  CHECK(counts.reused == kThreadCount * kCallCount - 1);
+  CHECK(object.created == 1);
+}
+
+int main() {
+  TestActivations();
+  TestKeys();
+  TestFailure();
+  TestClear();
+  TestThreads();
+  return 0;
+}
@@ -0,0 +1,130 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "sink_proxy_cache.h"
+
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "check.h"
+
+// Stands in for a sink proxy. The value is the cookie it was resolved for.
+using FakeProxy = std::shared_ptr<uint32_t>;
+using FakeProxyCache = SinkProxyCache<FakeProxy>;
+
+static FakeProxy Resolve(uint32_t cookie) {
+  return std::make_shared<uint32_t>(cookie);
+}
+
+// Steady-state delivery only resolves each sink once per thread, however
+// many events the threads deliver.
+static void TestLookupsPerEvent() {
+  static constexpr int kThreadCount = 4;
+  static constexpr uint32_t kSinkCount = 3;
+  static constexpr int kEventCount = 10000;
+
+  FakeProxyCache proxies;
+  for (uint32_t cookie = 1; cookie <= kSinkCount; ++cookie) {
+    proxies.Register(cookie, cookie);
+  }
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreadCount; ++i) {
+    threads.emplace_back([&] {
+      FakeProxyCache::ThreadCache cache(&proxies);
+      for (int event = 0; event < kEventCount; ++event) {
+        uint32_t cookie = event % kSinkCount + 1;
+        FakeProxy proxy = proxies.Find(cache, cookie, cookie, [&] {
+          return Resolve(cookie);
+        });
+        CHECK(proxy && *proxy == cookie);
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  CHECK(proxies.GetLookupCount() == kThreadCount * kSinkCount);
+}
+
+static void TestRevoke() {
+  FakeProxyCache proxies;
+  FakeProxyCache::ThreadCache first(&proxies);
+  FakeProxyCache::ThreadCache second(&proxies);
+  auto resolve = [] { return Resolve(7); };
+  proxies.Register(7, 1);
+  FakeProxy proxy = proxies.Find(first, 7, 1, resolve);
+  CHECK(proxies.Find(second, 7, 1, resolve) != proxy);
+  CHECK(proxies.GetLookupCount() == 2);
+
+  // The proxies of every thread are handed back, and the caches no longer
+  // hold them.
+  std::vector<FakeProxy> revoked = proxies.Revoke(7);
+  CHECK(revoked.size() == 2);
+  revoked.clear();
+  CHECK(proxy.use_count() == 1);
+
+  // A proxy resolved after the sink was revoked is not cached.
+  proxies.Find(first, 7, 1, resolve);
+  proxies.Find(first, 7, 1, resolve);
+  CHECK(proxies.GetLookupCount() == 4);
+
+  // A later registration reusing the cookie gets a new serial, which misses
+  // the proxies of the old one.
+  proxies.Register(7, 2);
+  proxies.Find(first, 7, 2, resolve);
+  proxies.Find(first, 7, 2, resolve);
+  CHECK(proxies.GetLookupCount() == 5);
+  proxies.Find(first, 7, 1, resolve);
+  CHECK(proxies.GetLookupCount() == 6);
+  proxies.Find(first, 7, 2, resolve);
+  CHECK(proxies.GetLookupCount() == 6);
+}
+
+static void TestFailedLookup() {
+  FakeProxyCache proxies;
+  FakeProxyCache::ThreadCache cache(&proxies);
+  proxies.Register(9, 1);
+  CHECK(!proxies.Find(cache, 9, 1, [] { return FakeProxy(); }));
+  CHECK(proxies.Find(cache, 9, 1, [] { return Resolve(9); }));
+  CHECK(proxies.GetLookupCount() == 2);
+}
+
+// A thread's cache leaves the set when the thread is done, so revoking
+// later does not reach it.
+static void TestThreadExit() {
+  FakeProxyCache proxies;
+  proxies.Register(3, 1);
+  FakeProxy proxy;
+  std::thread thread([&] {
+    FakeProxyCache::ThreadCache cache(&proxies);
+    proxy = proxies.Find(cache, 3, 1, [] { return Resolve(3); });
+  });
+  thread.join();
+  CHECK(proxy.use_count() == 1);
+  CHECK(proxies.Revoke(3).empty());
+}
+
+int main() {
+  TestLookupsPerEvent();
+  TestRevoke();
+  TestFailedLookup();
+  TestThreadExit();
+  return 0;
+}
@@ -0,0 +1,166 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "stats_page.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "check.h"
+
+static uint32_t GetProcessId() {
+#ifdef _WIN32
+  return GetCurrentProcessId();
+#else
+  return static_cast<uint32_t>(getpid());
+#endif
+}
+
+// Every word of a published block holds the same value, so a torn copy
+// shows up as two different words.
+static void Fill(StatsData &data, uint64_t value) {
+  uint64_t *words = reinterpret_cast<uint64_t *>(&data);
+  for (size_t i = 0; i < sizeof(StatsData) / sizeof(uint64_t); ++i) {
+    words[i] = value;
+  }
+}
+
+static bool IsUniform(const StatsData &data) {
+  const uint64_t *words = reinterpret_cast<const uint64_t *>(&data);
+  for (size_t i = 1; i < sizeof(StatsData) / sizeof(uint64_t); ++i) {
+    if (words[i] != words[0])
+      return false;
+  }
+  return true;
+}
+
+static void TestMissingMapping() {
+  StatsMapping reader;
+  StatsData data;
+  CHECK(!reader.Open(GetProcessId()) || !reader.Read(data));
+}
+
+static void TestRoundTrip() {
+  StatsMapping writer;
+  CHECK(writer.Create(GetProcessId()));
+  StatsMapping reader;
+  CHECK(reader.Open(GetProcessId()));
+
+  StatsData data;
+  std::memset(&data, 0, sizeof(data));
+  data.processId = GetProcessId();
+  data.liveContainers = 3;
+  data.classCount = 1;
+  data.classes[0].activations = 42;
+  writer.Publish(data);
+
+  StatsData copy;
+  CHECK(reader.Read(copy));
+  CHECK(std::memcmp(&copy, &data, sizeof(data)) == 0);
+
+  // A reader cannot publish.
+  Fill(data, 7);
+  reader.Publish(data);
+  CHECK(reader.Read(copy));
+  CHECK(copy.liveContainers == 3);
+}
+
+static void TestDiagnosticText() {
+  StatsDiagnostic item;
+  StatsMapping::SetText(item, "Warning: Title Text");
+  CHECK(StatsMapping::GetText(item) == "Warning: Title Text");
+
+  // Long text is cut before the sequence that does not fit.
+  std::string text(sizeof(item.text) - 2, 'x');
+  text += "\xC3\xA9";
+  StatsMapping::SetText(item, text);
+  CHECK(StatsMapping::GetText(item) == text.substr(0, text.size() - 2));
+}
+
+static void TestFormat() {
+  StatsData data;
+  std::memset(&data, 0, sizeof(data));
+  data.poolHits = 5;
+  data.poolMisses = 2;
+  std::ostringstream out;
+  StatsMapping::Format(data, out);
+  CHECK(out.str().find("Pool hits:          5\n") != std::string::npos);
+  CHECK(out.str().find("Pool misses:        2\n") != std::string::npos);
+}
+
+static void TestConcurrentReads() {
+  static constexpr uint64_t kPublishCount = 20000;
+
+  StatsMapping writer;
+  CHECK(writer.Create(GetProcessId()));
+  StatsData data;
+  Fill(data, 0);
+  writer.Publish(data);
+
+  std::atomic<bool> done{false};
+  std::atomic<uint64_t> reads{0};
+  std::atomic<uint64_t> torn{0};
+  std::thread reader([&] {
+    StatsMapping mapping;
+    if (!mapping.Open(GetProcessId())) {
+      torn++;
+      return;
+    }
+    StatsData copy;
+    uint64_t last = 0;
+    while (!done.load(std::memory_order_acquire)) {
+      if (!mapping.Read(copy))
+        continue;
+      reads++;
+      // Copies are consistent and never go back in time.
+      if (!IsUniform(copy) || copy.processId < last) {
+        torn++;
+      }
+      last = copy.processId;
+    }
+  });
+
+  for (uint64_t i = 1; i <= kPublishCount; ++i) {
+    Fill(data, i);
+    writer.Publish(data);
+  }
+  done.store(true, std::memory_order_release);
+  reader.join();
+
+  CHECK(torn == 0);
+  CHECK(reads > 0);
+}
+
+int main() {
+  TestMissingMapping();
+  TestRoundTrip();
+  TestDiagnosticText();
+  TestFormat();
+  TestConcurrentReads();
+  return 0;
+}
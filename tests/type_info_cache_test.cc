@@ -0,0 +1,137 @@
+// Copyright 2025 Yunseong Hwang
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-FileCopyrightText: 2025 Yunseong Hwang
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "type_info_cache.h"
+
+#include <windows.h>
+
+#include <oleauto.h>
+
+#include "check.h"
+
+// {6F3A52B1-0C1D-4E7A-9B0E-2D5C7A1F9E01}
+static const GUID kLibId = {
+    0x6f3a52b1, 0x0c1d, 0x4e7a, {0x9b, 0x0e, 0x2d, 0x5c, 0x7a, 0x1f, 0x9e, 0x01}
+};
+// {6F3A52B1-0C1D-4E7A-9B0E-2D5C7A1F9E02}
+static const CLSID kClassId = {
+    0x6f3a52b1, 0x0c1d, 0x4e7a, {0x9b, 0x0e, 0x2d, 0x5c, 0x7a, 0x1f, 0x9e, 0x02}
+};
+
+// Answers from an in-memory type library with a single coclass, and counts
+// how often the cache asks.
+class FakeTypeLibProvider : public TypeLibProvider {
+public:
+  HRESULT readResult = S_OK;
+  int readCount = 0;
+  CComPtr<ITypeLib> typeLib;
+
+  HRESULT ReadTypeLibId(REFCLSID rclsid, GUID *pLibid) override {
+    ++readCount;
+    if (FAILED(readResult))
+      return readResult;
+    if (!IsEqualCLSID(rclsid, kClassId))
+      return REGDB_E_CLASSNOTREG;
+    *pLibid = kLibId;
+    return S_OK;
+  }
+
+  HRESULT
+  FindLatestVersion(REFGUID libid, USHORT *pMajor, USHORT *pMinor) override {
+    if (!IsEqualGUID(libid, kLibId))
+      return TYPE_E_LIBNOTREGISTERED;
+    *pMajor = 1;
+    *pMinor = 0;
+    return S_OK;
+  }
+
+  HRESULT LoadTypeLib(
+      REFGUID libid, USHORT major, USHORT minor, ITypeLib **ppTL
+  ) override {
+    if (!IsEqualGUID(libid, kLibId) || major != 1 || minor != 0)
+      return TYPE_E_LIBNOTREGISTERED;
+    return typeLib.CopyTo(ppTL);
+  }
+};
+
+static CComPtr<ITypeLib> CreateFakeTypeLib() {
+  CComPtr<ICreateTypeLib2> library;
+  SYSKIND kind = sizeof(void *) == 8 ? SYS_WIN64 : SYS_WIN32;
+  CHECK(SUCCEEDED(CreateTypeLib2(kind, L"fake.tlb", &library)));
+  CHECK(SUCCEEDED(library->SetGuid(kLibId)));
+  CHECK(SUCCEEDED(library->SetVersion(1, 0)));
+  CComPtr<ICreateTypeInfo> coclass;
+  CHECK(SUCCEEDED(library->CreateTypeInfo(
+      const_cast<LPOLESTR>(L"FakeClass"), TKIND_COCLASS, &coclass
+  )));
+  CHECK(SUCCEEDED(coclass->SetGuid(kClassId)));
+  CHECK(SUCCEEDED(coclass->LayOut()));
+  CComQIPtr<ITypeLib> typeLib(library);
+  CHECK(typeLib);
+  return typeLib;
+}
+
+static void TestCachesSuccess() {
+  auto provider = QSharedPointer<FakeTypeLibProvider>::create();
+  provider->typeLib = CreateFakeTypeLib();
+  HostTypeInfoCache::SetProvider(provider);
+
+  QSharedPointer<const HostTypeInfo> info = HostTypeInfoCache::Lookup(kClassId);
+  CHECK(info && SUCCEEDED(info->result));
+  CHECK(IsEqualGUID(info->libid, kLibId));
+  CHECK(info->major == 1 && info->minor == 0);
+  CHECK(info->classInfo);
+  // The coclass has no default source interface.
+  CHECK(info->defaultSourceResult == TYPE_E_ELEMENTNOTFOUND);
+
+  CHECK(HostTypeInfoCache::Lookup(kClassId) == info);
+  CHECK(provider->readCount == 1);
+}
+
+static void TestExpiresFailures() {
+  auto provider = QSharedPointer<FakeTypeLibProvider>::create();
+  provider->typeLib = CreateFakeTypeLib();
+  provider->readResult = REGDB_E_KEYMISSING;
+  HostTypeInfoCache::SetProvider(provider);
+
+  // Within its lifetime a failure is answered from the cache.
+  HostTypeInfoCache::SetFailureLifetime(60000);
+  CHECK(HostTypeInfoCache::Lookup(kClassId)->result == REGDB_E_KEYMISSING);
+  CHECK(HostTypeInfoCache::Lookup(kClassId)->result == REGDB_E_KEYMISSING);
+  CHECK(provider->readCount == 1);
+
+  // Once it has expired, a class registered meanwhile is found.
+  HostTypeInfoCache::SetFailureLifetime(0);
+  provider->readResult = S_OK;
+  QSharedPointer<const HostTypeInfo> info = HostTypeInfoCache::Lookup(kClassId);
+  CHECK(SUCCEEDED(info->result));
+  CHECK(provider->readCount == 2);
+
+  // Successes never expire.
+  CHECK(HostTypeInfoCache::Lookup(kClassId) == info);
+  CHECK(provider->readCount == 2);
+}
+
+int main() {
+  CHECK(SUCCEEDED(CoInitializeEx(nullptr, COINIT_MULTITHREADED)));
+  TestCachesSuccess();
+  TestExpiresFailures();
+  HostTypeInfoCache::SetProvider(nullptr);
+  CoUninitialize();
+  return 0;
+}